@@ -0,0 +1,191 @@
+#include <algorithm>
+#include <cassert>
+
+#include "alloc_stats.h"
+
+/*****************************************************
+ * Implementation of class AllocStats                 *
+ ******************************************************/
+
+// Blocks allocated by all operations
+size_t AllocStats::total_allocations() const {
+	size_t n = 0;
+
+	for (size_t a : allocations) {
+		n += a;
+	}
+	return n;
+}
+
+// Blocks freed by all operations
+size_t AllocStats::total_frees() const {
+	size_t n = 0;
+
+	for (size_t f : frees) {
+		n += f;
+	}
+	return n;
+}
+
+// Average number of nodes visited by a membership query
+double AllocStats::average_walk() const {
+	return (member_queries == 0) ? 0.0 : static_cast<double>(member_steps) / member_queries;
+}
+
+// Name of an operation
+const char* AllocStats::op_name(Op op) {
+	static const char* names[NumOps] = {"construct",  "copy",    "insert",  "erase", "union", "intersection",
+										"difference", "symmetric difference", "clear", "destroy", "other"};
+
+	return names[op];
+}
+
+// Overloaded stream insertion operator<<
+std::ostream& operator<<(std::ostream& os, const AllocStats& s) {
+	os << "live " << s.live_bytes << " B in " << s.live_blocks << " blocks, peak " << s.peak_bytes << " B;";
+
+	for (int op = 0; op < AllocStats::NumOps; ++op) {
+		if (s.allocations[op] == 0 && s.frees[op] == 0) continue;
+
+		os << " " << AllocStats::op_name(static_cast<AllocStats::Op>(op)) << " +" << s.allocations[op] << "/-"
+		   << s.frees[op];
+	}
+
+	os << "; is_member " << s.member_queries << " queries, " << s.average_walk() << " nodes per query";
+
+	return os;
+}
+
+/*****************************************************
+ * Implementation of class AllocCounter               *
+ ******************************************************/
+
+// Create the counters, detailed counting on or off
+AllocCounter::AllocCounter(bool detailed)
+	: detailed{detailed} {
+}
+
+// Count an allocated block
+void AllocCounter::allocated(AllocStats::Op op, size_t bytes) {
+	live_blocks.fetch_add(1, std::memory_order_relaxed);
+	if (!detailed.load(std::memory_order_relaxed)) return;
+
+	allocations[op].fetch_add(1, std::memory_order_relaxed);
+	int64_t live = live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+	update_peak(live);
+}
+
+// Count a freed block
+void AllocCounter::freed(AllocStats::Op op, size_t bytes) {
+	int64_t blocks = live_blocks.fetch_sub(1, std::memory_order_relaxed);
+	assert(blocks > 0);  // number of existing blocks can never be negative
+	(void)blocks;
+	if (!detailed.load(std::memory_order_relaxed)) return;
+
+	frees[op].fetch_add(1, std::memory_order_relaxed);
+	live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+// Count a membership query
+void AllocCounter::walked(size_t steps) {
+	if (!detailed.load(std::memory_order_relaxed)) return;
+
+	member_queries.fetch_add(1, std::memory_order_relaxed);
+	member_steps.fetch_add(steps, std::memory_order_relaxed);
+}
+
+// Turn detailed counting on or off
+void AllocCounter::set_detailed(bool on, size_t bytes_per_block) {
+	if (on && !is_detailed()) {
+		int64_t bytes = live_blocks.load(std::memory_order_relaxed) * static_cast<int64_t>(bytes_per_block);
+		live_bytes.store(bytes, std::memory_order_relaxed);
+		update_peak(bytes);
+	}
+
+	detailed.store(on, std::memory_order_relaxed);
+}
+
+// Detailed counting is on
+bool AllocCounter::is_detailed() const {
+	return detailed.load(std::memory_order_relaxed);
+}
+
+// Set the memory currently used
+void AllocCounter::set_live(size_t blocks, size_t bytes) {
+	live_blocks.store(blocks, std::memory_order_relaxed);
+	live_bytes.store(bytes, std::memory_order_relaxed);
+	update_peak(bytes);
+}
+
+// Copy the counters
+AllocStats AllocCounter::snapshot() const {
+	AllocStats s;
+
+	s.live_bytes = static_cast<size_t>(std::max<int64_t>(0, live_bytes.load(std::memory_order_relaxed)));
+	s.live_blocks = static_cast<size_t>(std::max<int64_t>(0, live_blocks.load(std::memory_order_relaxed)));
+	s.peak_bytes = static_cast<size_t>(peak_bytes.load(std::memory_order_relaxed));
+
+	for (int op = 0; op < AllocStats::NumOps; ++op) {
+		s.allocations[op] = allocations[op].load(std::memory_order_relaxed);
+		s.frees[op] = frees[op].load(std::memory_order_relaxed);
+	}
+
+	s.member_queries = member_queries.load(std::memory_order_relaxed);
+	s.member_steps = member_steps.load(std::memory_order_relaxed);
+
+	return s;
+}
+
+// Reset the counters, except the memory currently used
+void AllocCounter::reset() {
+	for (int op = 0; op < AllocStats::NumOps; ++op) {
+		allocations[op].store(0, std::memory_order_relaxed);
+		frees[op].store(0, std::memory_order_relaxed);
+	}
+
+	member_queries.store(0, std::memory_order_relaxed);
+	member_steps.store(0, std::memory_order_relaxed);
+	peak_bytes.store(live_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+// Raise the peak to bytes, if it is lower
+void AllocCounter::update_peak(int64_t bytes) {
+	int64_t peak = peak_bytes.load(std::memory_order_relaxed);
+
+	while (bytes > peak && !peak_bytes.compare_exchange_weak(peak, bytes, std::memory_order_relaxed)) {
+	}
+}
+
+/*****************************************************
+ * Implementation of class AllocStatsDump             *
+ ******************************************************/
+
+// Start the thread writing the statistics every period
+AllocStatsDump::AllocStatsDump(std::string label, std::function<AllocStats()> source, std::ostream& os,
+							   std::chrono::milliseconds period)
+	: label{std::move(label)}, source{std::move(source)}, os{os}, period{period}, stop{false} {
+	worker = std::thread{[this]() {
+		std::unique_lock<std::mutex> lock{mtx};
+
+		while (!cv.wait_for(lock, this->period, [this]() { return stop; })) {
+			dump();
+		}
+	}};
+}
+
+// Stop the thread and write the statistics a last time
+AllocStatsDump::~AllocStatsDump() {
+	{
+		std::lock_guard<std::mutex> lock{mtx};
+		stop = true;
+	}
+
+	cv.notify_one();
+	worker.join();
+	dump();
+}
+
+// Write the current statistics
+void AllocStatsDump::dump() {
+	os << label << ": " << source() << "\n";
+}
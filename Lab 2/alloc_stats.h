@@ -0,0 +1,177 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#pragma once
+
+/** Memory statistics of a container, or of all containers of a type
+ *
+ * A snapshot returned by AllocCounter::snapshot()
+ * Allocations and frees are counted per operation of the container, see Op
+ */
+struct AllocStats {
+	// Operations of the container the allocations are charged to
+	enum Op {
+		Construct, Copy, Insert, Erase, Union, Intersection, Difference, SymmetricDifference, Clear, Destroy, Other, NumOps
+	};
+
+	size_t live_bytes = 0;   // bytes currently allocated
+	size_t live_blocks = 0;  // blocks (e.g. nodes) currently allocated
+	size_t peak_bytes = 0;   // largest value of live_bytes
+
+	size_t allocations[NumOps] = {};  // number of blocks allocated by each operation
+	size_t frees[NumOps] = {};        // number of blocks freed by each operation
+
+	size_t member_queries = 0;  // number of membership queries
+	size_t member_steps = 0;    // nodes visited by the membership queries
+
+	/** Return the number of blocks allocated by all operations
+	 *
+	 */
+	size_t total_allocations() const;
+
+	/** Return the number of blocks freed by all operations
+	 *
+	 */
+	size_t total_frees() const;
+
+	/** Return the average number of nodes visited by a membership query, 0 if there was none
+	 *
+	 */
+	double average_walk() const;
+
+	/** Return the name of operation op, e.g. "union"
+	 *
+	 */
+	static const char* op_name(Op op);
+};
+
+/** Overloaded operator<<
+ *
+ * Write the statistics in one line, operations without allocations nor frees are omitted
+ *
+ */
+std::ostream& operator<<(std::ostream& os, const AllocStats& s);
+
+/** Thread-safe accumulator of the allocations of a container, or of all containers of a type
+ *
+ * Containers call allocated() and freed() for every block (e.g. node) they create and delete,
+ * and walked() for every membership query. The counters are relaxed atomics,
+ * so they can be updated by Sets used in different threads
+ *
+ * A counter shared by many threads makes them all write to the same cache line:
+ * with detailed counting off, only the number of live blocks is updated
+ */
+class AllocCounter {
+public:
+	explicit AllocCounter(bool detailed = true);
+
+	// Copying is disallowed, the counters belong to one container or type
+	AllocCounter(const AllocCounter&) = delete;
+	AllocCounter& operator=(const AllocCounter&) = delete;
+
+	/** Count a block of bytes allocated by operation op
+	 *
+	 */
+	void allocated(AllocStats::Op op, size_t bytes);
+
+	/** Count a block of bytes freed by operation op
+	 *
+	 */
+	void freed(AllocStats::Op op, size_t bytes);
+
+	/** Count a membership query that visited steps nodes
+	 *
+	 * Nothing is counted if detailed counting is off
+	 *
+	 */
+	void walked(size_t steps);
+
+	/** Turn detailed counting on or off
+	 *
+	 * When off, allocated() and freed() only update the number of live blocks,
+	 * and walked() does nothing. When turned on, the live bytes are recomputed
+	 * from the live blocks, every block having bytes_per_block bytes
+	 * Meant to be called while no other thread updates the counters
+	 *
+	 */
+	void set_detailed(bool on, size_t bytes_per_block);
+
+	/** Test whether detailed counting is on
+	 *
+	 */
+	bool is_detailed() const;
+
+	/** Set the memory currently used, for containers that compute it instead of counting every block
+	 *
+	 * The peak is updated accordingly
+	 *
+	 */
+	void set_live(size_t blocks, size_t bytes);
+
+	/** Return a copy of the counters
+	 *
+	 */
+	AllocStats snapshot() const;
+
+	/** Reset the counters of operations and queries, and the peak to the current memory
+	 *
+	 * The memory currently used is kept
+	 *
+	 */
+	void reset();
+
+private:
+	std::atomic<bool> detailed;  // read by every update, kept out of the cache line of the counters
+
+	alignas(64) std::atomic<int64_t> live_blocks{0};
+	std::atomic<int64_t> live_bytes{0};
+	std::atomic<int64_t> peak_bytes{0};
+
+	std::atomic<size_t> allocations[AllocStats::NumOps] = {};
+	std::atomic<size_t> frees[AllocStats::NumOps] = {};
+
+	std::atomic<size_t> member_queries{0};
+	std::atomic<size_t> member_steps{0};
+
+	void update_peak(int64_t bytes);
+};
+
+/** Periodic dump of memory statistics
+ *
+ * While the object exists, a background thread writes the statistics returned by source
+ * to os every period, e.g.
+ *   AllocStatsDump dump{"Set", &Set::global_alloc_stats, std::cerr, std::chrono::seconds{10}};
+ * The statistics are written once more when the object is destroyed
+ */
+class AllocStatsDump {
+public:
+	AllocStatsDump(std::string label, std::function<AllocStats()> source, std::ostream& os,
+				   std::chrono::milliseconds period);
+
+	// Stop the thread, after a last dump
+	~AllocStatsDump();
+
+	AllocStatsDump(const AllocStatsDump&) = delete;
+	AllocStatsDump& operator=(const AllocStatsDump&) = delete;
+
+private:
+	std::string label;
+	std::function<AllocStats()> source;
+	std::ostream& os;
+	std::chrono::milliseconds period;
+
+	std::mutex mtx;
+	std::condition_variable cv;
+	bool stop;
+	std::thread worker;
+
+	void dump();
+};
@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <cmath>
+
+#include "bloom.h"
+
+/*****************************************************
+ * Implementation of the member functions             *
+ ******************************************************/
+
+// Create an empty filter sized for capacity values and false-positive rate fp_rate
+BlockedBloomFilter::BlockedBloomFilter(size_t capacity, double fp_rate)
+	: cap{std::max<size_t>(capacity, 1)}, rate{fp_rate} {
+	// Optimal number of bits per value and of bits set per value for a classic Bloom filter,
+	// blocking costs a little accuracy, which is compensated with one extra bit per value
+	const double ln2 = std::log(2.0);
+	double bits_per_value = -std::log(fp_rate) / (ln2 * ln2) + 1.0;
+
+	num_bits = std::min(16, std::max(1, static_cast<int>(std::lround(bits_per_value * ln2))));
+
+	size_t n = static_cast<size_t>(std::ceil(cap * bits_per_value / 512));
+	blocks.assign(std::max<size_t>(n, 1), Block{});
+}
+
+// Copy constructor
+BlockedBloomFilter::BlockedBloomFilter(const BlockedBloomFilter& f)
+	: blocks{f.blocks}, num_bits{f.num_bits}, cap{f.cap}, rate{f.rate},
+	  rejected{f.rejected.load(std::memory_order_relaxed)},
+	  passed{f.passed.load(std::memory_order_relaxed)},
+	  false_positives{f.false_positives.load(std::memory_order_relaxed)} {
+}
+
+// Copy assignment operator
+BlockedBloomFilter& BlockedBloomFilter::operator=(const BlockedBloomFilter& f) {
+	blocks = f.blocks;
+	num_bits = f.num_bits;
+	cap = f.cap;
+	rate = f.rate;
+	rejected.store(f.rejected.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	passed.store(f.passed.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	false_positives.store(f.false_positives.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	return *this;
+}
+
+// Add the key of a value
+void BlockedBloomFilter::add_key(uint64_t key) {
+	uint64_t h = mix_hash(key);
+	Block& b = blocks[block_index(h)];
+
+	// Double hashing, with a second hash independent of the block, selects the bits inside the block
+	uint64_t g = mix_hash(h);
+	uint32_t h1 = static_cast<uint32_t>(g);
+	uint32_t h2 = static_cast<uint32_t>(g >> 32) | 1;
+
+	for (int i = 0; i < num_bits; ++i) {
+		uint32_t bit = (h1 + i * h2) & 511;
+		b.words[bit >> 6] |= 1ULL << (bit & 63);
+	}
+}
+
+// Test whether the key of a value may have been added
+bool BlockedBloomFilter::might_contain_key(uint64_t key) const {
+	uint64_t h = mix_hash(key);
+	const Block& b = blocks[block_index(h)];
+
+	uint64_t g = mix_hash(h);
+	uint32_t h1 = static_cast<uint32_t>(g);
+	uint32_t h2 = static_cast<uint32_t>(g >> 32) | 1;
+
+	for (int i = 0; i < num_bits; ++i) {
+		uint32_t bit = (h1 + i * h2) & 511;
+
+		if ((b.words[bit >> 6] & (1ULL << (bit & 63))) == 0) {
+			rejected.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+	}
+
+	passed.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+// Count a false positive
+void BlockedBloomFilter::record_false_positive() const {
+	false_positives.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Remove all values
+void BlockedBloomFilter::clear() {
+	std::fill(blocks.begin(), blocks.end(), Block{});
+}
+
+size_t BlockedBloomFilter::capacity() const {
+	return cap;
+}
+
+double BlockedBloomFilter::fp_rate() const {
+	return rate;
+}
+
+BlockedBloomFilter::Stats BlockedBloomFilter::stats() const {
+	Stats s;
+	s.rejected = rejected.load(std::memory_order_relaxed);
+	s.passed = passed.load(std::memory_order_relaxed);
+	s.false_positives = false_positives.load(std::memory_order_relaxed);
+	return s;
+}
+
+/* ******************************************** *
+ * Private Member Functions -- Implementation   *
+ * ******************************************** */
+
+// Block selected by the high bits of hash h, mapped to [0, blocks.size()) without a division
+size_t BlockedBloomFilter::block_index(uint64_t h) const {
+	return ((h >> 32) * blocks.size()) >> 32;
+}
@@ -0,0 +1,99 @@
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "hash.h"
+
+#pragma once
+
+/** Class to represent a cache-line blocked Bloom filter of integral values
+ *
+ * The bits are grouped in blocks of one cache line (512 bits).
+ * All bits of a value are set in the same block, selected by the hash of the value,
+ * so a query touches a single cache line
+ *
+ * A Bloom filter may answer "maybe" for an absent value (false positive)
+ * but never answers "no" for a value that was added
+ */
+class BlockedBloomFilter {
+public:
+	// Counters of the queries, for debug and tuning purposes, see stats()
+	struct Stats {
+		size_t rejected = 0;         // queries answered "no" by the filter
+		size_t passed = 0;           // queries answered "maybe"
+		size_t false_positives = 0;  // queries answered "maybe" for an absent value, as reported by the user
+	};
+
+	/** Create an empty filter
+	 *
+	 * \param capacity expected number of values
+	 * \param fp_rate false-positive budget, e.g. 0.01 for 1%, when capacity values have been added
+	 *
+	 */
+	BlockedBloomFilter(size_t capacity, double fp_rate);
+
+	// Copies have the bits and the counters of f
+	BlockedBloomFilter(const BlockedBloomFilter& f);
+	BlockedBloomFilter& operator=(const BlockedBloomFilter& f);
+
+	/** Add integral value val to the filter
+	 *
+	 */
+	template <typename T>
+	void add(T val) {
+		add_key(hash_key(val));
+	}
+
+	/** Test whether integral value val may have been added
+	 *
+	 * Return false if val was certainly not added, updates the counters
+	 *
+	 */
+	template <typename T>
+	bool might_contain(T val) const {
+		return might_contain_key(hash_key(val));
+	}
+
+	/** Report that the last query answered "maybe" for an absent value
+	 *
+	 */
+	void record_false_positive() const;
+
+	/** Remove all values, the counters are kept
+	 *
+	 */
+	void clear();
+
+	size_t capacity() const;
+
+	double fp_rate() const;
+
+	/** Return a copy of the counters
+	 *
+	 * Queries running in other threads may be counted or not
+	 *
+	 */
+	Stats stats() const;
+
+private:
+	struct alignas(64) Block {
+		uint64_t words[8];
+	};
+
+	std::vector<Block> blocks;
+	int num_bits;   // bits set per value
+	size_t cap;     // expected number of values
+	double rate;    // false-positive budget
+
+	// Counters of the queries, relaxed atomics updated by the const queries of any thread
+	mutable std::atomic<size_t> rejected{0};
+	mutable std::atomic<size_t> passed{0};
+	mutable std::atomic<size_t> false_positives{0};
+
+	void add_key(uint64_t key);
+
+	bool might_contain_key(uint64_t key) const;
+
+	size_t block_index(uint64_t h) const;
+};
@@ -0,0 +1,313 @@
+#include <cassert>
+#include <functional>
+#include <thread>
+
+#include "concurrent_set.h"
+
+/** Struct ConcurrentSet::Node
+ *
+ * A node of the singly linked list. The link is atomic, so that readers
+ * see a new node only after it has been fully constructed
+ *
+ */
+struct ConcurrentSet::Node {
+	explicit Node(int nodeVal = 0, Node* nextPtr = nullptr)
+		: value{nodeVal}, next{nextPtr} {
+		++count_nodes;
+	}
+
+	~Node() {
+		--count_nodes;
+		assert(count_nodes >= 0);  // number of existing nodes can never be negative
+	}
+
+	Node(const Node&) = delete;
+	Node& operator=(const Node&) = delete;
+
+	const int value;          // int stored in the Node, never modified
+	std::atomic<Node*> next;  // Pointer to the next Node, nullptr for the last Node
+
+	static std::atomic<int> count_nodes;  // total number of existing nodes -- to help to detect bugs in the code
+};
+
+std::atomic<int> ConcurrentSet::Node::count_nodes{0};
+
+/** Class ConcurrentSet::ReadGuard
+ *
+ * Announce the current epoch in a free reader slot while a traversal is running
+ *
+ */
+class ConcurrentSet::ReadGuard {
+public:
+	explicit ReadGuard(const ConcurrentSet& S) {
+		// Start looking for a free slot at a position given by the thread, to avoid contention
+		static thread_local size_t start = std::hash<std::thread::id>{}(std::this_thread::get_id());
+
+		for (size_t i = start;; ++i) {
+			slot = &S.readers[i % max_readers];
+
+			uint64_t free = 0;
+			if (slot->epoch.compare_exchange_strong(free, S.epoch.load() + 1)) break;
+		}
+
+		// The traversal must not start before the announcement is visible to the writer
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+	}
+
+	~ReadGuard() {
+		slot->epoch.store(0);
+	}
+
+private:
+	ReaderSlot* slot;
+};
+
+/*****************************************************
+ * Implementation of the member functions             *
+ ******************************************************/
+
+int ConcurrentSet::get_count_nodes() {
+	return Node::count_nodes;
+}
+
+// Default constructor
+ConcurrentSet::ConcurrentSet()
+	: head{new Node{}}, counter{0}, epoch{0} {
+}
+
+// Constructor to create a ConcurrentSet from Set S
+ConcurrentSet::ConcurrentSet(const Set& S)
+	: ConcurrentSet{} {
+	*this += S;
+}
+
+// Destructor
+ConcurrentSet::~ConcurrentSet() {
+	Node* ptr = head;
+
+	while (ptr != nullptr) {
+		Node* next = ptr->next.load();
+		delete ptr;
+		ptr = next;
+	}
+
+	for (auto& nodes : retired) {
+		for (Node* p : nodes) delete p;
+	}
+}
+
+// Return number of elements
+size_t ConcurrentSet::cardinality() const {
+	return counter.load();
+}
+
+// Test membership, lock-free
+bool ConcurrentSet::is_member(int val) const {
+	ReadGuard guard{*this};
+
+	Node* ptr = head->next.load(std::memory_order_acquire);
+	while (ptr != nullptr && ptr->value < val) {
+		ptr = ptr->next.load(std::memory_order_acquire);
+	}
+
+	return (ptr != nullptr && ptr->value == val);
+}
+
+// Return true, if every value belongs to b
+bool ConcurrentSet::operator<=(const Set& b) const {
+	ReadGuard guard{*this};
+
+	Node* ptr = head->next.load(std::memory_order_acquire);
+	auto it = b.begin();
+
+	while (ptr != nullptr && it != b.end()) {
+		if (ptr->value > *it) {
+			++it;
+			continue;
+		}
+
+		if (ptr->value != *it) return false;
+		ptr = ptr->next.load(std::memory_order_acquire);
+		++it;
+	}
+
+	return (ptr == nullptr);
+}
+
+// Return true, if every value of b belongs to *this
+bool ConcurrentSet::contains_all(const Set& b) const {
+	ReadGuard guard{*this};
+
+	Node* ptr = head->next.load(std::memory_order_acquire);
+	auto it = b.begin();
+
+	while (ptr != nullptr && it != b.end()) {
+		if (*it > ptr->value) {
+			ptr = ptr->next.load(std::memory_order_acquire);
+			continue;
+		}
+
+		if (ptr->value != *it) return false;
+		ptr = ptr->next.load(std::memory_order_acquire);
+		++it;
+	}
+
+	return (it == b.end());
+}
+
+// Copy the current values into a Set
+Set ConcurrentSet::to_set() const {
+	std::vector<int> values;
+
+	{
+		ReadGuard guard{*this};
+
+		Node* ptr = head->next.load(std::memory_order_acquire);
+		while (ptr != nullptr) {
+			values.push_back(ptr->value);
+			ptr = ptr->next.load(std::memory_order_acquire);
+		}
+	}
+
+	return Set{values};
+}
+
+// Insert val
+bool ConcurrentSet::insert(int val) {
+	std::lock_guard<std::mutex> lock{writer};
+
+	Node* pred = head;
+	Node* ptr = pred->next.load();
+
+	while (ptr != nullptr && ptr->value < val) {
+		pred = ptr;
+		ptr = ptr->next.load();
+	}
+
+	if (ptr != nullptr && ptr->value == val) return false;
+
+	link_after(pred, val);
+	return true;
+}
+
+// Remove val
+bool ConcurrentSet::erase(int val) {
+	std::lock_guard<std::mutex> lock{writer};
+
+	Node* pred = head;
+	Node* ptr = pred->next.load();
+
+	while (ptr != nullptr && ptr->value < val) {
+		pred = ptr;
+		ptr = ptr->next.load();
+	}
+
+	if (ptr == nullptr || ptr->value != val) return false;
+
+	unlink_after(pred);
+	try_reclaim();
+	return true;
+}
+
+// Insert all values of S
+ConcurrentSet& ConcurrentSet::operator+=(const Set& S) {
+	std::lock_guard<std::mutex> lock{writer};
+
+	Node* pred = head;
+	auto it = S.begin();
+
+	while (it != S.end()) {
+		Node* ptr = pred->next.load();
+
+		if (ptr == nullptr || ptr->value > *it) {
+			pred = link_after(pred, *it);
+			++it;
+		}
+		else {
+			if (ptr->value == *it) ++it;
+			pred = ptr;
+		}
+	}
+
+	return *this;
+}
+
+// Remove all values of S
+ConcurrentSet& ConcurrentSet::operator-=(const Set& S) {
+	std::lock_guard<std::mutex> lock{writer};
+
+	Node* pred = head;
+	auto it = S.begin();
+
+	while (it != S.end()) {
+		Node* ptr = pred->next.load();
+
+		if (ptr == nullptr) break;
+
+		if (ptr->value > *it) {
+			++it;
+		}
+		else if (ptr->value < *it) {
+			pred = ptr;
+		}
+		else {
+			unlink_after(pred);
+			++it;
+		}
+	}
+
+	try_reclaim();
+	return *this;
+}
+
+/* ******************************************** *
+ * Private Member Functions -- Implementation   *
+ * ******************************************** */
+
+// Insert a new node storing val after pred and publish it to the readers
+// Return a pointer to the new node
+ConcurrentSet::Node* ConcurrentSet::link_after(Node* pred, int val) {
+	Node* ptr = new Node{val, pred->next.load()};
+
+	pred->next.store(ptr, std::memory_order_release);
+	++counter;
+
+	return ptr;
+}
+
+// Unlink the node after pred and retire it
+// The link of the removed node is kept, so that readers visiting it can continue their traversal
+void ConcurrentSet::unlink_after(Node* pred) {
+	Node* ptr = pred->next.load();
+
+	pred->next.store(ptr->next.load(), std::memory_order_release);
+	--counter;
+
+	retire(ptr);
+}
+
+// Put a node unlinked in the current epoch aside, until no reader can be visiting it
+void ConcurrentSet::retire(Node* ptr) {
+	retired[epoch.load() % 3].push_back(ptr);
+}
+
+// Advance the epoch, if all active readers have announced the current one,
+// and delete the nodes retired two epochs ago
+void ConcurrentSet::try_reclaim() {
+	// The slots must be read after the nodes have been unlinked
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	uint64_t e = epoch.load();
+
+	for (const ReaderSlot& slot : readers) {
+		uint64_t announced = slot.epoch.load();
+		if (announced != 0 && announced != e + 1) return;
+	}
+
+	epoch.store(e + 1);
+
+	// Nodes retired in epoch e-1 can no longer be reached: all readers are in epoch e or later
+	std::vector<Node*>& nodes = retired[(e + 2) % 3];
+	for (Node* p : nodes) delete p;
+	nodes.clear();
+}
@@ -0,0 +1,119 @@
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "set.h"
+
+#pragma once
+
+/** Class to represent a Set of ints shared by concurrent threads
+ *
+ * ConcurrentSet is implemented as a sorted singly linked list with atomic links
+ * Any number of reader threads (is_member, subset tests, ...) traverse the list lock-free,
+ * while updates (insert, erase, +=, -=) are serialized by a mutex
+ *
+ * Removed nodes are not deleted immediately, since readers may still be visiting them.
+ * Epoch-based reclamation is used: a reader announces the current epoch when it starts a traversal,
+ * and a node unlinked in epoch e is deleted once the epoch has advanced to e+2,
+ * which requires all readers that could have seen the node to have finished
+ *
+ * Readers see each update atomically, but a traversal may or may not see updates
+ * made while it is running. The ConcurrentSet must not be destroyed while it is in use
+ */
+class ConcurrentSet {
+public:
+	// Default constructor: create an empty ConcurrentSet
+	ConcurrentSet();
+
+	// Constructor to create a ConcurrentSet with all values in Set S
+	explicit ConcurrentSet(const Set& S);
+
+	// Destructor: deallocate all nodes, including the ones waiting for reclamation
+	~ConcurrentSet();
+
+	// Copying is disallowed, the nodes are shared by the threads using *this
+	ConcurrentSet(const ConcurrentSet&) = delete;
+	ConcurrentSet& operator=(const ConcurrentSet&) = delete;
+
+	/** Count the number of values stored in the ConcurrentSet
+	 *
+	 */
+	size_t cardinality() const;
+
+	/** Test whether val belongs to the ConcurrentSet -- lock-free
+	 *
+	 */
+	bool is_member(int val) const;
+
+	/** Test whether every value of *this belongs to Set b -- lock-free
+	 *
+	 */
+	bool operator<=(const Set& b) const;
+
+	/** Test whether every value of Set b belongs to *this -- lock-free
+	 *
+	 */
+	bool contains_all(const Set& b) const;
+
+	/** Return a Set with the current values
+	 *
+	 */
+	Set to_set() const;
+
+	/** Insert val, return true if it did not belong to the ConcurrentSet
+	 *
+	 */
+	bool insert(int val);
+
+	/** Remove val, return true if it belonged to the ConcurrentSet
+	 *
+	 */
+	bool erase(int val);
+
+	/** Insert all values of Set S, with one merge
+	 *
+	 */
+	ConcurrentSet& operator+=(const Set& S);
+
+	/** Remove all values of Set S, with one merge
+	 *
+	 */
+	ConcurrentSet& operator-=(const Set& S);
+
+	/** Return number of existing nodes of all ConcurrentSets
+	 *
+	 * Used for debug purposes
+	 *
+	 */
+	static int get_count_nodes();
+
+private:
+	struct Node;
+
+	// Announcement of a reader: 0 if the slot is free, otherwise 1 + epoch of the reader
+	struct alignas(64) ReaderSlot {
+		std::atomic<uint64_t> epoch{0};
+	};
+
+	static const int max_readers = 64;  // threads reading at the same time, more readers wait for a slot
+
+	Node* head;                         // Pointer to the dummy header Node
+	std::atomic<size_t> counter;        // number of values in the ConcurrentSet
+	std::mutex writer;                  // serializes the updates
+
+	std::atomic<uint64_t> epoch;        // current epoch
+	mutable ReaderSlot readers[max_readers];
+	std::vector<Node*> retired[3];      // nodes unlinked in epochs e, e-1, e-2 -- accessed by the writer only
+
+	// RAII guard announcing a reader for the duration of a traversal
+	class ReadGuard;
+
+	void retire(Node* ptr);
+
+	void try_reclaim();
+
+	Node* link_after(Node* pred, int val);
+
+	void unlink_after(Node* pred);
+};
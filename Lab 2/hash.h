@@ -0,0 +1,31 @@
+#include <cstdint>
+#include <type_traits>
+
+#pragma once
+
+/** Finalizer of splitmix64
+ *
+ * A cheap 64-bit mixing function with good avalanche, used to hash the values of a Set
+ * by the sketches (sketch.h) and the Bloom filter (bloom.h)
+ *
+ */
+inline uint64_t mix_hash(uint64_t x) {
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9ULL;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebULL;
+	x ^= x >> 31;
+	return x;
+}
+
+/** Key of an integral value, hashed with mix_hash
+ *
+ * The bits of the value, zero-extended to 64 bits, so that e.g. the int -1 and
+ * the uint32_t 0xffffffff have the same key
+ *
+ */
+template <typename T>
+uint64_t hash_key(T val) {
+	static_assert(std::is_integral<T>::value, "only integral values can be hashed");
+	return static_cast<uint64_t>(static_cast<std::make_unsigned_t<T>>(val));
+}
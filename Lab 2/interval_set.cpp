@@ -0,0 +1,266 @@
+#include <algorithm>
+#include <cassert>
+
+#include "interval_set.h"
+
+/*****************************************************
+ * Implementation of the member functions             *
+ ******************************************************/
+
+// Default constructor
+IntervalSet::IntervalSet()
+	: counter{0} {
+}
+
+// Conversion constructor
+IntervalSet::IntervalSet(int val)
+	: intervals{Run{val, val}}, counter{1} {
+}
+
+// Constructor to create an IntervalSet from Set S
+IntervalSet::IntervalSet(const Set& S)
+	: IntervalSet{} {
+	for (int val : S) {
+		append(val, val);
+	}
+}
+
+// Constructor to create an IntervalSet from a sorted vector v
+IntervalSet::IntervalSet(const std::vector<int>& v)
+	: IntervalSet{} {
+	for (int val : v) {
+		append(val, val);
+	}
+}
+
+// Test whether the set is empty
+bool IntervalSet::is_empty() const {
+	return (counter == 0);
+}
+
+// Return number of values
+size_t IntervalSet::cardinality() const {
+	return counter;
+}
+
+// Return number of runs
+size_t IntervalSet::number_of_runs() const {
+	return intervals.size();
+}
+
+// Return the runs
+const std::vector<IntervalSet::Run>& IntervalSet::runs() const {
+	return intervals;
+}
+
+// Test membership: find the last run starting at or before val
+bool IntervalSet::is_member(int val) const {
+	auto it = std::upper_bound(intervals.begin(), intervals.end(), val,
+							   [](int v, const Run& r) { return v < r.first; });
+
+	if (it == intervals.begin()) return false;
+
+	--it;
+	return (val <= it->second);
+}
+
+// Make the set empty
+void IntervalSet::make_empty() {
+	intervals.clear();
+	counter = 0;
+}
+
+// Insert all values in [lo, hi]
+void IntervalSet::insert_range(int lo, int hi) {
+	if (hi < lo) return;
+
+	// Runs overlapping or touching [lo, hi] are [first, last)
+	auto first = std::lower_bound(intervals.begin(), intervals.end(), lo,
+								  [](const Run& r, int v) { return static_cast<long long>(r.second) + 1 < v; });
+	auto last = std::upper_bound(first, intervals.end(), hi,
+								 [](int v, const Run& r) { return static_cast<long long>(v) + 1 < r.first; });
+
+	Run merged{lo, hi};
+
+	for (auto it = first; it != last; ++it) {
+		merged.first = std::min(merged.first, it->first);
+		merged.second = std::max(merged.second, it->second);
+		counter -= static_cast<size_t>(static_cast<long long>(it->second) - it->first + 1);
+	}
+
+	counter += static_cast<size_t>(static_cast<long long>(merged.second) - merged.first + 1);
+
+	auto pos = intervals.erase(first, last);
+	intervals.insert(pos, merged);
+}
+
+// Remove all values in [lo, hi]
+void IntervalSet::erase_range(int lo, int hi) {
+	if (hi < lo) return;
+
+	IntervalSet cut;
+	cut.append(lo, hi);
+
+	*this -= cut;
+}
+
+// Return a Set with the same values
+Set IntervalSet::to_set() const {
+	std::vector<int> values;
+	values.reserve(counter);
+
+	for (const Run& r : intervals) {
+		for (long long v = r.first; v <= r.second; ++v) {
+			values.push_back(static_cast<int>(v));
+		}
+	}
+
+	return Set{values};
+}
+
+// Return true, if every run of *this lies inside a run of b
+bool IntervalSet::operator<=(const IntervalSet& b) const {
+	if (counter > b.counter) return false;
+
+	size_t j = 0;
+
+	for (const Run& r : intervals) {
+		while (j < b.intervals.size() && b.intervals[j].second < r.first) {
+			++j;
+		}
+
+		if (j == b.intervals.size()) return false;
+		if (b.intervals[j].first > r.first || b.intervals[j].second < r.second) return false;
+	}
+
+	return true;
+}
+
+// Runs are kept in a canonical form, so equal sets have equal runs
+bool IntervalSet::operator==(const IntervalSet& b) const {
+	return (counter == b.counter && intervals == b.intervals);
+}
+
+bool IntervalSet::operator!=(const IntervalSet& b) const {
+	return !(*this == b);
+}
+
+bool IntervalSet::operator<(const IntervalSet& b) const {
+	return (counter != b.counter && *this <= b);
+}
+
+// Union: merge both lists of runs by their first value
+IntervalSet& IntervalSet::operator+=(const IntervalSet& S) {
+	std::vector<Run> a;
+	a.swap(intervals);
+	counter = 0;
+
+	size_t i = 0;
+	size_t j = 0;
+
+	while (i < a.size() || j < S.intervals.size()) {
+		if (j == S.intervals.size() || (i < a.size() && a[i].first <= S.intervals[j].first)) {
+			append(a[i].first, a[i].second);
+			++i;
+		}
+		else {
+			append(S.intervals[j].first, S.intervals[j].second);
+			++j;
+		}
+	}
+
+	return *this;
+}
+
+// Intersection: overlap of each pair of overlapping runs
+IntervalSet& IntervalSet::operator*=(const IntervalSet& S) {
+	std::vector<Run> a;
+	a.swap(intervals);
+	counter = 0;
+
+	size_t i = 0;
+	size_t j = 0;
+
+	while (i < a.size() && j < S.intervals.size()) {
+		int lo = std::max(a[i].first, S.intervals[j].first);
+		int hi = std::min(a[i].second, S.intervals[j].second);
+
+		if (lo <= hi) append(lo, hi);
+
+		// Move past the run that ends first
+		if (a[i].second < S.intervals[j].second) ++i;
+		else ++j;
+	}
+
+	return *this;
+}
+
+// Difference: cut the runs of S out of the runs of *this
+IntervalSet& IntervalSet::operator-=(const IntervalSet& S) {
+	std::vector<Run> a;
+	a.swap(intervals);
+	counter = 0;
+
+	size_t j = 0;
+
+	for (const Run& r : a) {
+		long long lo = r.first;
+
+		while (j < S.intervals.size() && S.intervals[j].first <= r.second) {
+			const Run& cut = S.intervals[j];
+
+			if (cut.second >= lo) {
+				if (cut.first > lo) append(lo, cut.first - 1LL);
+				lo = cut.second + 1LL;
+			}
+
+			// A cut extending past r may also cut the next run
+			if (cut.second >= r.second) break;
+			++j;
+		}
+
+		if (lo <= r.second) append(lo, r.second);
+	}
+
+	return *this;
+}
+
+// Overloaded stream insertion operator<<
+std::ostream& operator<<(std::ostream& os, const IntervalSet& b) {
+	if (b.is_empty()) {
+		os << "Set is empty!";
+	} else {
+		os << "{ ";
+		for (const IntervalSet::Run& r : b.intervals) {
+			if (r.first == r.second) os << r.first << " ";
+			else os << "[" << r.first << ", " << r.second << "] ";
+		}
+
+		os << "}";
+	}
+
+	return os;
+}
+
+/* ******************************************** *
+ * Private Member Functions -- Implementation   *
+ * ******************************************** */
+
+// Append [lo, hi] at the end of the runs, merging it with the last run if they overlap or touch
+// lo must not be smaller than the first value of the last run
+void IntervalSet::append(long long lo, long long hi) {
+	if (!intervals.empty() && lo <= static_cast<long long>(intervals.back().second) + 1) {
+		Run& last = intervals.back();
+
+		assert(lo >= last.first);
+
+		if (hi > last.second) {
+			counter += static_cast<size_t>(hi - last.second);
+			last.second = static_cast<int>(hi);
+		}
+		return;
+	}
+
+	intervals.push_back(Run{static_cast<int>(lo), static_cast<int>(hi)});
+	counter += static_cast<size_t>(hi - lo + 1);
+}
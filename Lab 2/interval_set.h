@@ -0,0 +1,153 @@
+#include <iostream>
+#include <vector>
+#include <utility>
+
+#include "set.h"
+
+#pragma once
+
+/** Class to represent a Set of ints as runs of consecutive values
+ *
+ * IntervalSet is implemented as a sorted vector of disjoint intervals [lo, hi]
+ * Two intervals never overlap nor touch, i.e. [1, 3] and [4, 6] are stored as [1, 6]
+ *
+ * Memory and the cost of the Set operations depend on the number of runs r,
+ * not on the number of values: is_member is O(log r) and +=, *=, -=, <= are O(r1 + r2)
+ * It supports the same operations as class Set, plus range insertion and removal
+ */
+class IntervalSet {
+public:
+	using Run = std::pair<int, int>;  // interval [first, second] of consecutive values
+
+	// Default constructor: create an empty IntervalSet
+	IntervalSet();
+
+	// Conversion constructor: Convert val into a singleton {val}
+	IntervalSet(int val);
+
+	/** Constructor to create an IntervalSet with all values in Set S
+	 *
+	 * Consecutive values of S are stored as a single run
+	 *
+	 */
+	explicit IntervalSet(const Set& S);
+
+	/** Constructor to create an IntervalSet from a sorted vector of ints, without repetitions
+	 *
+	 */
+	explicit IntervalSet(const std::vector<int>& v);
+
+	/** Test whether the IntervalSet is empty
+	 *
+	 */
+	bool is_empty() const;
+
+	/** Count the number of values stored in the IntervalSet
+	 *
+	 */
+	size_t cardinality() const;
+
+	/** Count the number of runs of consecutive values
+	 *
+	 */
+	size_t number_of_runs() const;
+
+	/** Return the runs, in increasing order
+	 *
+	 */
+	const std::vector<Run>& runs() const;
+
+	/** Test whether val belongs to the IntervalSet, with a binary search over the runs
+	 *
+	 */
+	bool is_member(int val) const;
+
+	/** Transform the IntervalSet into an empty set
+	 *
+	 */
+	void make_empty();
+
+	/** Insert all values v such that lo <= v <= hi
+	 *
+	 * Runs overlapping or touching [lo, hi] are merged into one run
+	 *
+	 */
+	void insert_range(int lo, int hi);
+
+	/** Remove all values v such that lo <= v <= hi
+	 *
+	 */
+	void erase_range(int lo, int hi);
+
+	/** Return a Set with the same values
+	 *
+	 */
+	Set to_set() const;
+
+	/** Test whether IntervalSet *this is a subset of IntervalSet b
+	 *
+	 */
+	bool operator<=(const IntervalSet& b) const;
+
+	/** Test whether IntervalSet *this and b represent the same set
+	 *
+	 */
+	bool operator==(const IntervalSet& b) const;
+
+	/** Test whether IntervalSet *this and b represent different sets
+	 *
+	 */
+	bool operator!=(const IntervalSet& b) const;
+
+	/** Test whether IntervalSet *this is a strict subset of IntervalSet b
+	 *
+	 */
+	bool operator<(const IntervalSet& b) const;
+
+	/** Modify *this such that it becomes the union of *this with S
+	 *
+	 */
+	IntervalSet& operator+=(const IntervalSet& S);
+
+	/** Modify *this such that it becomes the intersection of *this with S
+	 *
+	 */
+	IntervalSet& operator*=(const IntervalSet& S);
+
+	/** Modify *this such that it becomes the difference between *this and S
+	 *
+	 */
+	IntervalSet& operator-=(const IntervalSet& S);
+
+private:
+	std::vector<Run> intervals;  // sorted, disjoint and non-touching runs
+	size_t counter;              // number of values in the IntervalSet
+
+	void append(long long lo, long long hi);
+
+	/* ***************************** *
+	 * Overloaded Global Operators   *
+	 * ***************************** */
+
+	/** Overloaded operator<<
+	 *
+	 * Runs are written as [lo, hi], single values as they are
+	 *
+	 */
+	friend std::ostream& operator<<(std::ostream& os, const IntervalSet& b);
+
+	// Overloaded operator+: union S1+S2
+	friend IntervalSet operator+(IntervalSet S1, const IntervalSet& S2) {
+		return (S1 += S2);
+	}
+
+	// Overloaded operator*: intersection S1*S2
+	friend IntervalSet operator*(IntervalSet S1, const IntervalSet& S2) {
+		return (S1 *= S2);
+	}
+
+	// Overloaded operator-: difference S1-S2
+	friend IntervalSet operator-(IntervalSet S1, const IntervalSet& S2) {
+		return (S1 -= S2);
+	}
+};
@@ -0,0 +1,122 @@
+#include <cstddef>
+#include <iterator>
+
+#include "set.h"
+#include "node.h"
+
+#if __cplusplus >= 202002L
+#include <ranges>
+#endif
+
+#pragma once
+
+/* **********************************************************
+ * Class to represent a bi-directional iterator for Sets     *
+ * Values are visited in increasing order and cannot be      *
+ * modified through the iterator, since the list is sorted   *
+ * ***********************************************************/
+
+template <typename T, typename Compare, typename Allocator>
+class BasicSet<T, Compare, Allocator>::Iterator {
+public:
+	friend class BasicSet<T, Compare, Allocator>;
+
+	using iterator_category = std::bidirectional_iterator_tag;
+	using value_type = T;
+	using difference_type = std::ptrdiff_t;
+	using pointer = const T*;
+	using reference = const T&;
+
+	Iterator() : node_ptr{nullptr} {}
+
+	// Return a reference to the value
+	reference operator*() const {
+		return node_ptr->value;
+	}
+
+	// Return the address of the value
+	pointer operator->() const {
+		return &node_ptr->value;
+	}
+
+	bool operator==(const Iterator& it) const {
+		return node_ptr == it.node_ptr;
+	}
+
+	bool operator!=(const Iterator& it) const {
+		return !(*this == it);
+	}
+
+	// Pre increment
+	Iterator& operator++() {
+		node_ptr = node_ptr->next;
+		return *this;
+	}
+
+	// Post increment
+	Iterator operator++(int) {
+		Iterator old{*this};
+		++(*this);
+		return old;
+	}
+
+	// Pre decrement
+	Iterator& operator--() {
+		node_ptr = node_ptr->prev;
+		return *this;
+	}
+
+	// Post decrement
+	Iterator operator--(int) {
+		Iterator old{*this};
+		--(*this);
+		return old;
+	}
+
+private:
+	const Node* node_ptr;
+
+	explicit Iterator(const Node* ptr) : node_ptr{ptr} {}
+};
+
+// Ranges of a Set are cheap to copy and do not own the values
+#if __cplusplus >= 202002L
+using set_view_base = std::ranges::view_base;
+#else
+struct set_view_base {};
+#endif
+
+/** A view of the values in [first, last) of a Set
+ *
+ * No values are copied, the view refers to the nodes of the Set
+ * It is invalidated when the Set is modified
+ */
+template <typename T, typename Compare, typename Allocator>
+class BasicSet<T, Compare, Allocator>::Range : public set_view_base {
+public:
+	Range() = default;
+
+	Range(Iterator first, Iterator last) : first{first}, last{last} {}
+
+	Iterator begin() const {
+		return first;
+	}
+
+	Iterator end() const {
+		return last;
+	}
+
+	bool empty() const {
+		return first == last;
+	}
+
+private:
+	Iterator first;
+	Iterator last;
+};
+
+#if __cplusplus >= 202002L
+static_assert(std::bidirectional_iterator<Set::Iterator>);
+static_assert(std::ranges::bidirectional_range<const Set>);
+static_assert(std::ranges::view<Set::Range>);
+#endif
@@ -1,11 +1,71 @@
 #include <iostream>
 #include <iomanip>
 #include <sstream>
+#include <fstream>
 #include <cassert>  //assert
+#include <cmath>    //std::abs
+#include <climits>  //INT_MIN, INT_MAX
+#include <algorithm>
+#include <thread>
+#include <string>
+#include <cstdint>
+#include <functional>
+#include <chrono>
+#include <cstdio>   //std::remove
 
 #include "set.h"
+#include "sketch.h"
+#include "concurrent_set.h"
+#include "bloom.h"
+#include "interval_set.h"
+#include "alloc_stats.h"
+#include "persistent_set.h"
+#include "set_io.h"
 //#include <vld.h>
 
+// Number of live allocations made by CountingAllocator
+int counting_allocations = 0;
+
+// Allocator counting the live allocations, to test the Allocator parameter of BasicSet
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() = default;
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        ++counting_allocations;
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) {
+        --counting_allocations;
+        std::allocator<T>{}.deallocate(p, n);
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>&) const {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const CountingAllocator<U>&) const {
+        return false;
+    }
+};
+
+// Ordering with state, to test that the expressions keep the ordering of their operands
+struct Direction {
+    bool descending = false;
+
+    bool operator()(int a, int b) const {
+        return descending ? b < a : a < b;
+    }
+};
+
 int main() {
     /*****************************************************
      * TEST PHASE 0                                       *
@@ -14,12 +74,14 @@ int main() {
      ******************************************************/
     std::cout << "TEST PHASE 0: default and conversion constructor\n";
 
-    Set A1{};
-    Set A2{-4};
+    {
+        Set A1{};
+        Set A2{-4};
+
+        Set A3 = A1 * A2;
 
-    Set A3 = A1 * A2;
-    
-    std::cout << A1 << " " << A2 << " intersection: " << A3 << "\n";
+        std::cout << A1 << " " << A2 << " intersection: " << A3 << "\n";
+    }
 
     {
         Set S1{};
@@ -289,5 +351,1085 @@ int main() {
 
     assert(Set::get_count_nodes() == 0);
 
+    /*****************************************************
+     * TEST PHASE 10                                      *
+     * Compound expressions: only the result is allocated *
+     ******************************************************/
+    std::cout << "\nTEST PHASE 10: compound expressions\n";
+
+    {
+        std::vector<int> A1{1, 3, 5, 8};
+        std::vector<int> A2{2, 3, 7};
+        std::vector<int> A3{1, 2, 3, 4, 5};
+        std::vector<int> A4{2};
+
+        Set S1{A1};
+        Set S2{A2};
+        Set S3{A3};
+        Set S4{A4};
+        assert(Set::get_count_nodes() == 21);
+
+        // (S1 + S2) * S3 - S4 = {1 3 5}
+        Set S5 = (S1 + S2) * S3 - S4;
+        assert(Set::get_count_nodes() == 26);
+
+        // test
+        std::vector<int> A5{1, 3, 5};
+        assert(S5 == Set{A5});
+
+        // comparing an expression does not allocate any node
+        assert((S1 + S2) * S3 - S4 == S5);
+        assert(S1 * S2 != S5);
+        assert(Set::get_count_nodes() == 26);
+
+        // expressions support the other queries of a Set, also without allocating
+        assert((S1 + S2).cardinality() == 6 && (S1 * S2).cardinality() == 1);
+        assert(!(S1 + S2).is_empty() && (S1 * S4).is_empty());
+        assert(S5 <= S1 + S2 && S5 < S1 + S2 && (S1 * S2) <= S5 && (S1 * S2) < S5);
+        assert(S5 <= (S1 + S2) * S3 - S4 && !(S5 < (S1 + S2) * S3 - S4) && !(S1 + S2 <= S3));
+        assert(S1 - S1 < S4 && !(S4 * 9 < S1 - S1) && S4 * 9 <= S1 - S1);
+        assert(Set::get_count_nodes() == 26);
+
+        std::ostringstream os{};
+        os << S1 - (S2 + 8) << " " << S4 * 3;
+
+        std::string tmp{os.str()};
+        assert((tmp == std::string{"{ 1 5 } Set is empty!"}));
+    }
+
+    assert(Set::get_count_nodes() == 0);
+
+    /*****************************************************
+     * TEST PHASE 11                                      *
+     * operator+=, operator*=, operator-= and operator<=  *
+     * compared with the expressions                      *
+     ******************************************************/
+    std::cout << "\nTEST PHASE 11: compound assignments and expressions\n";
+
+    {
+        std::vector<int> A1{};
+        std::vector<int> A2{};
+
+        for (int i = 0; i < 1000; ++i) {
+            if (i % 2 == 0) A1.push_back(i);
+            if (i % 3 == 0) A2.push_back(i);
+        }
+
+        Set S1{A1};
+        Set S2{A2};
+
+        // expected results, computed by the fused merge of the expressions
+        Set U = S1 + S2;
+        Set I = S1 * S2;
+        Set D = S1 - S2;
+
+        Set S3{S1};
+        S3 += S2;
+        assert(S3 == U);
+        assert(S3.cardinality() == U.cardinality());
+
+        S3 = S1;
+        S3 *= S2;
+        assert(S3 == I);
+
+        S3 = S1;
+        S3 -= S2;
+        assert(S3 == D);
+
+        assert(I <= S1 && I <= S2);
+        assert((S1 <= S2) == false);
+    }
+
+    assert(Set::get_count_nodes() == 0);
+
+    /*****************************************************
+     * TEST PHASE 12                                      *
+     * insert, erase, insert_batch and erase_batch        *
+     ******************************************************/
+    std::cout << "\nTEST PHASE 12: insert, erase and batches\n";
+
+    {
+        std::vector<int> A1{1, 3, 5};
+        Set S1{A1};
+
+        assert(S1.insert(4));
+        assert(S1.insert(4) == false);
+        assert(S1.erase(1));
+        assert(S1.erase(2) == false);
+        assert(Set::get_count_nodes() == 5);
+
+        // unsorted with repetitions
+        assert(S1.insert_batch({9, 0, 4, 9, 7, 0, 2}) == 4);
+        assert(Set::get_count_nodes() == 9);
+
+        std::vector<int> A2{0, 2, 3, 4, 5, 7, 9};
+        assert(S1 == Set{A2});
+
+        assert(S1.erase_batch({9, 1, 8, 0, 9, 4}) == 3);
+
+        std::vector<int> A3{2, 3, 5, 7};
+        assert(S1 == Set{A3});
+
+        // large batch, sorted in parallel
+        std::vector<int> A4{};
+        for (int i = 0; i < 3000; ++i) {
+            A4.push_back((i * 7919) % 1000);
+        }
+
+        Set::set_parallel_threshold(0);
+        Set S2{};
+        assert(S2.insert_batch(A4) == 1000);
+        assert(S2.erase_batch(A4) == 1000);
+        assert(S2.is_empty());
+        Set::set_parallel_threshold(100000);
+    }
+
+    assert(Set::get_count_nodes() == 0);
+
+    /*****************************************************
+     * TEST PHASE 13                                      *
+     * Iterators, lower_bound, upper_bound and ranges     *
+     ******************************************************/
+    std::cout << "\nTEST PHASE 13: iterators\n";
+
+    {
+        std::vector<int> A1{1, 3, 5, 8};
+        Set S1{A1};
+
+        // Inorder traversal
+        std::vector<int> V1{S1.begin(), S1.end()};
+        assert(V1 == A1);
+
+        // Backwards traversal
+        std::vector<int> V2{};
+        for (auto it = S1.end(); it != S1.begin();) {
+            V2.push_back(*--it);
+        }
+        assert((V2 == std::vector<int>{8, 5, 3, 1}));
+
+        assert(*S1.lower_bound(3) == 3);
+        assert(*S1.upper_bound(3) == 5);
+        assert(S1.lower_bound(9) == S1.end());
+
+        std::vector<int> V3{};
+        for (int v : S1.values_between(2, 7)) {
+            V3.push_back(v);
+        }
+        assert((V3 == std::vector<int>{3, 5}));
+        assert(S1.values_between(6, 7).empty());
+
+        // no nodes are allocated by the iterators
+        assert(Set::get_count_nodes() == 6);
+    }
+
+    assert(Set::get_count_nodes() == 0);
+
+    /*****************************************************
+     * TEST PHASE 14                                      *
+     * Copy-on-write                                      *
+     ******************************************************/
+    std::cout << "\nTEST PHASE 14: copy-on-write\n";
+
+    {
+        std::vector<int> A1{1, 3, 5};
+        Set S1{A1};
+        S1.set_copy_on_write(true);
+
+        // copies share the nodes
+        Set S2{S1};
+        Set S3{};
+        S3 = S1;
+        assert(Set::get_count_nodes() == 5);
+        assert(S1.is_shared() && S2.is_shared() && S3.is_copy_on_write());
+
+        // the first modification clones the nodes
+        S2 += 4;
+        assert(Set::get_count_nodes() == 11);
+
+        std::vector<int> A2{1, 3, 4, 5};
+        assert(S2 == Set{A2});
+        assert(S1 == Set{A1} && S3 == Set{A1});
+
+        S3.make_empty();
+        assert(S3.is_empty() && S1.cardinality() == 3);
+        assert(Set::get_count_nodes() == 13);
+        assert(S1.is_shared() == false);
+
+        S1.set_copy_on_write(false);
+        Set S4{S1};
+        assert(Set::get_count_nodes() == 18);
+    }
+
+    assert(Set::get_count_nodes() == 0);
+
+    {
+        // the sketches and the Bloom filter are shared with the nodes, until the first modification
+        std::vector<int> A1{};
+        std::vector<int> A2{};
+        for (int i = 0; i < 1000; i += 2) {
+            A1.push_back(i);
+            A2.push_back(i + 1);
+        }
+
+        Set S1{A1};
+        S1.set_sketching(true);
+        S1.set_bloom_filter(0.01);
+        S1.set_copy_on_write(true);
+        const SetSketch* sketch = &S1.sketch();
+
+        Set S2{S1};
+        assert(S2.bloom_filter() == S1.bloom_filter() && &S2.sketch() == sketch);
+
+        S2.insert_batch(A2);
+        assert(S2.bloom_filter() != S1.bloom_filter() && &S1.sketch() == sketch);
+        assert(S2.is_member(1) && S1.is_member(1) == false);
+        assert(S2.sketch().cardinality() > 1.5 * S1.sketch().cardinality());
+
+        S1.set_copy_on_write(false);
+        Set S3{S1};
+        assert(S3.bloom_filter() != S1.bloom_filter() && S3.is_member(998));
+    }
+
+    assert(Set::get_count_nodes() == 0);
+
+    /*****************************************************
+     * TEST PHASE 15                                      *
+     * relation, intersection_size, union_size, jaccard,  *
+     * is_disjoint                                        *
+     ******************************************************/
+    std::cout << "\nTEST PHASE 15: relation queries\n";
+
+    {
+        std::vector<int> A1{1, 3, 5, 8};
+        std::vector<int> A2{3, 5};
+        std::vector<int> A3{2, 3, 7};
+        std::vector<int> A4{2, 4};
+
+        Set S1{A1};
+        Set S2{A2};
+        Set S3{A3};
+        Set S4{A4};
+        assert(Set::get_count_nodes() == 19);
+
+        assert(S1.relation(Set{A1}) == Set::Relation::Equal);
+        assert(S2.relation(S1) == Set::Relation::Subset);
+        assert(S1.relation(S2) == Set::Relation::Superset);
+        assert(S1.relation(S4) == Set::Relation::Disjoint);
+        assert(S1.relation(S3) == Set::Relation::Overlapping);
+        assert(Set{}.relation(S1) == Set::Relation::Subset);
+
+        assert(S1.intersection_size(S3) == 1);
+        assert(S1.union_size(S3) == 6);
+        assert(S2.jaccard(S1) == 0.5);
+        assert(Set{}.jaccard(Set{}) == 1.0);
+        assert(S1.is_disjoint(S4));
+        assert(S3.is_disjoint(S4) == false);
+
+        // no nodes are allocated by the queries
+        assert(Set::get_count_nodes() == 19);
+    }
+
+    assert(Set::get_count_nodes() == 0);
+
+    /*****************************************************
+     * TEST PHASE 16                                      *
+     * MinHash and HyperLogLog sketches                   *
+     ******************************************************/
+    std::cout << "\nTEST PHASE 16: sketches\n";
+
+    {
+        std::vector<int> A1{};
+        std::vector<int> A2{};
+
+        // |S1| = |S2| = 20000, |S1*S2| = 10000, jaccard = 1/3
+        for (int i = 0; i < 30000; ++i) {
+            if (i < 20000) A1.push_back(i);
+            if (i >= 10000) A2.push_back(i);
+        }
+
+        Set S1{A1};
+        Set S2{A2};
+        S1.set_sketching(true);
+        S2.set_sketching(true);
+
+        assert(std::abs(S1.sketch().cardinality() - 20000) < 20000 * 0.05);
+        assert(std::abs(S1.sketch().union_cardinality(S2.sketch()) - 30000) < 30000 * 0.05);
+        assert(std::abs(S1.sketch().jaccard(S2.sketch()) - S1.jaccard(S2)) < 0.15);
+
+        // the sketch of a union is maintained by +=
+        S1 += S2;
+        assert(std::abs(S1.sketch().cardinality() - 30000) < 30000 * 0.05);
+
+        // rebuilt after an intersection
+        S1 *= Set{A1};
+        assert(std::abs(S1.sketch().cardinality() - 20000) < 20000 * 0.05);
+
+        // LSH: only the similar sets become candidates
+        std::vector<SetSketch> sketches{S1.sketch(), S2.sketch(), SetSketch{Set{A1}}};
+        auto pairs = lsh_candidates(sketches, 32);
+        assert(std::find(pairs.begin(), pairs.end(), std::make_pair(size_t{0}, size_t{2})) != pairs.end());
+    }
+
+    {
+        // several threads read the invalidated sketches of one Set, and copy it: the rebuild is done once
+        Set S1{std::vector<int>{1, 2, 3}};
+        S1.set_sketching(true);
+        S1.insert_batch({4, 5});
+        S1.erase(5);
+        Set S2{S1};
+
+        std::vector<const SetSketch*> seen(4);
+        std::vector<std::thread> readers;
+        for (size_t i = 0; i < seen.size(); ++i) {
+            readers.emplace_back([&S1, &S2, &seen, i]() {
+                if (i % 2 == 1) {
+                    Set copy{S1};  // reads the sketches of S1 while other threads may rebuild them
+                    assert(copy.cardinality() == 4);
+                }
+                seen[i] = &S1.sketch();
+                assert(std::abs(S2.sketch().cardinality() - 4) < 1);
+            });
+        }
+        for (auto& r : readers) r.join();
+
+        assert(std::count(seen.begin(), seen.end(), &S1.sketch()) == 4);
+    }
+
+    assert(Set::get_count_nodes() == 0);
+
+    /*****************************************************
+     * TEST PHASE 17                                      *
+     * ConcurrentSet: readers and a writer in parallel    *
+     ******************************************************/
+    std::cout << "\nTEST PHASE 17: concurrent set\n";
+
+    {
+        std::vector<int> A1{};
+        std::vector<int> A2{};
+
+        for (int i = 0; i < 200; ++i) {
+            if (i % 2 == 0) A1.push_back(i);
+            else A2.push_back(i);
+        }
+
+        Set evens{A1};
+        Set odds{A2};
+        ConcurrentSet C{evens};
+        assert(ConcurrentSet::get_count_nodes() == 101);
+
+        // The even values are never removed, the odd values come and go
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 4; ++r) {
+            readers.emplace_back([&C, &evens]() {
+                for (int k = 0; k < 200; ++k) {
+                    assert(C.is_member(2 * (k % 100)));
+                    assert(C.contains_all(evens));
+                }
+            });
+        }
+
+        for (int k = 0; k < 50; ++k) {
+            C += odds;
+            C.erase(199);
+            C -= odds;
+        }
+
+        for (auto& t : readers) t.join();
+
+        assert(C.cardinality() == 100);
+        assert(C.to_set() == evens);
+        assert(C <= evens);
+        assert((C <= odds) == false);
+    }
+
+    assert(Set::get_count_nodes() == 0);
+    assert(ConcurrentSet::get_count_nodes() == 0);
+
+    /*****************************************************
+     * TEST PHASE 18                                      *
+     * Bloom filter prefilter for is_member               *
+     ******************************************************/
+    std::cout << "\nTEST PHASE 18: Bloom filter\n";
+
+    {
+        std::vector<int> A1{};
+        for (int i = 0; i < 10000; i += 2) {
+            A1.push_back(i);
+        }
+
+        Set S1{A1};
+        S1.set_bloom_filter(0.01);
+
+        // no false negatives
+        for (int v : A1) {
+            assert(S1.is_member(v));
+        }
+
+        // most absent values are rejected by the filter
+        for (int v = 1; v < 10000; v += 2) {
+            assert(S1.is_member(v) == false);
+        }
+
+        BlockedBloomFilter::Stats stats = S1.bloom_filter()->stats();
+        assert(stats.passed == 5000 + stats.false_positives);
+        assert(stats.false_positives < 5000 * 0.03);
+
+        // queries from several threads are all counted, 9999 is larger than all values and is not queried
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 4; ++t) {
+            readers.emplace_back([&S1]() {
+                for (int v = 1; v < 10000; v += 2) {
+                    assert(S1.is_member(v) == false);
+                }
+            });
+        }
+        for (auto& r : readers) r.join();
+
+        BlockedBloomFilter::Stats after = S1.bloom_filter()->stats();
+        assert(after.rejected + after.passed == stats.rejected + stats.passed + 4 * 4999);
+        assert(after.false_positives == 5 * stats.false_positives);
+
+        // the filter follows the operations
+        S1 += Set{1};
+        assert(S1.is_member(1));
+        S1.insert_batch({3, 5, 7});
+        assert(S1.is_member(7));
+        S1 -= Set{A1};
+        assert(S1.cardinality() == 4 && S1.is_member(0) == false && S1.is_member(5));
+
+        Set S2{S1};
+        assert(S2.bloom_filter() != nullptr && S2.is_member(3));
+    }
+
+    assert(Set::get_count_nodes() == 0);
+
+    /*****************************************************
+     * TEST PHASE 19                                      *
+     * Run-length interval sets                           *
+     ******************************************************/
+    std::cout << "\nTEST PHASE 19: interval sets\n";
+
+    {
+        IntervalSet I1{Set{std::vector<int>{1, 2, 3, 5, 7, 8, 9}}};
+        assert(I1.cardinality() == 7 && I1.number_of_runs() == 3);
+
+        std::ostringstream os{};
+        os << I1;
+        assert(os.str() == "{ [1, 3] 5 [7, 9] }");
+
+        assert(I1.is_member(1) && I1.is_member(5) && I1.is_member(9));
+        assert(I1.is_member(0) == false && I1.is_member(4) == false && I1.is_member(10) == false);
+
+        // touching runs are merged
+        I1.insert_range(4, 6);
+        assert(I1.number_of_runs() == 1 && I1.cardinality() == 9);
+
+        I1.insert_range(20, 1000000);
+        assert(I1.number_of_runs() == 2 && I1.cardinality() == 9 + 999981);
+
+        I1.erase_range(100, 199);
+        assert(I1.number_of_runs() == 3 && I1.is_member(100) == false && I1.is_member(200));
+
+        IntervalSet I2{};
+        I2.insert_range(0, 10);
+        I2.insert_range(150, 300);
+
+        IntervalSet I3 = I1 + I2;
+        assert(I3.number_of_runs() == 3 && I3.cardinality() == 11 + 80 + 999851);
+
+        IntervalSet I4 = I1 * I2;
+        assert(I4.cardinality() == 9 + 101 && I4.number_of_runs() == 2);
+        assert(I4 <= I1 && I4 <= I2 && I4 < I1);
+        assert((I1 <= I2) == false);
+
+        IntervalSet I5 = I1 - I2;
+        assert(I5.cardinality() == I1.cardinality() - I4.cardinality());
+        assert((I5 * I2).is_empty());
+        assert(I5 + I4 == I1);
+
+        // extreme values do not overflow
+        IntervalSet I6{};
+        I6.insert_range(INT_MAX - 1, INT_MAX);
+        I6.insert_range(INT_MIN, INT_MIN + 1);
+        assert(I6.cardinality() == 4 && I6.is_member(INT_MAX) && I6.is_member(INT_MIN));
+        I6 -= IntervalSet{INT_MAX};
+        assert(I6.cardinality() == 3);
+
+        // conversion back to Set
+        IntervalSet I7{std::vector<int>{-3, -2, 4, 5}};
+        assert(I7.to_set() == Set(std::vector<int>{-3, -2, 4, 5}));
+    }
+
+    assert(Set::get_count_nodes() == 0);
+
+    /*****************************************************
+     * TEST PHASE 20                                      *
+     * Sets of other types, orderings and allocators      *
+     ******************************************************/
+    std::cout << "\nTEST PHASE 20: generic sets\n";
+
+    {
+        using StringSet = BasicSet<std::string>;
+
+        StringSet S1{std::vector<std::string>{"apple", "banana", "cherry"}};
+        StringSet S2{std::vector<std::string>{"banana", "date"}};
+        assert(StringSet::get_count_nodes() == 9);
+
+        StringSet S3 = S1 + S2 - "apple";
+        std::ostringstream os{};
+        os << S3;
+        assert(os.str() == "{ banana cherry date }");
+
+        assert(S1 * S2 == StringSet{"banana"});
+        assert(S1.is_member("cherry") && S1.is_member("fig") == false);
+        assert(S1.relation(S2) == StringSet::Relation::Overlapping);
+
+        S1.insert_batch({"fig", "apple", "elder"});
+        S1 -= S2;
+        assert(S1.cardinality() == 4 && *S1.begin() == "apple" && *--S1.end() == "fig");
+
+        static_assert(!set_value_traits<std::string, std::less<std::string>>::hashable, "strings are not hashed");
+    }
+
+    assert(BasicSet<std::string>::get_count_nodes() == 0);
+
+    {
+        // Values outside the range of int, in decreasing order
+        using DescendingSet = BasicSet<int64_t, std::greater<int64_t>>;
+        const int64_t big = int64_t{1} << 40;
+
+        DescendingSet S1{std::vector<int64_t>{3 * big, 2 * big, big}};
+        DescendingSet S2{};
+        S2.insert(2 * big);
+        S2.insert(-big);
+        S2.insert(4 * big);
+
+        DescendingSet S3 = S1 + S2;
+        assert(S3.cardinality() == 5 && *S3.begin() == 4 * big && *--S3.end() == -big);
+        assert(S3.lower_bound(big) != S3.end() && *S3.lower_bound(big) == big);
+
+        // integral values keep the Bloom filter and the sketches
+        S3.set_bloom_filter(0.01);
+        assert(S3.is_member(2 * big) && S3.is_member(5 * big) == false);
+        S3.set_sketching(true);
+        assert(std::abs(S3.sketch().cardinality() - 5) < 1);
+
+        // an int and a uint32_t with the same bits have the same hash
+        BasicSet<uint32_t> U1{std::vector<uint32_t>{1, 2, 0xffffffffu}};
+        Set I1{std::vector<int>{-1, 1, 2}};
+        U1.set_sketching(true);
+        I1.set_sketching(true);
+        assert(U1.sketch().jaccard(I1.sketch()) == 1.0);
+    }
+
+    assert((BasicSet<int64_t, std::greater<int64_t>>::get_count_nodes() == 0));
+
+    {
+        using CountingSet = BasicSet<int, std::less<int>, CountingAllocator<int>>;
+
+        CountingSet S1{std::vector<int>{1, 2, 3}};
+        CountingSet S2{std::vector<int>{2, 3, 4}};
+        assert(counting_allocations == 10);  // nodes are allocated with the rebound allocator
+
+        {
+            CountingSet S3 = (S1 + S2) * S2;
+            assert(S3 == S2);
+            assert(counting_allocations == 15);
+        }
+
+        S1 += S2;
+        assert(counting_allocations == 11);
+        assert(CountingSet::get_count_nodes() == 11);
+        assert(Set::get_count_nodes() == 0);
+    }
+
+    assert(counting_allocations == 0);
+
+    assert((BasicSet<int, std::less<int>, CountingAllocator<int>>::get_count_nodes() == 0));
+
+    {
+        using DirectedSet = BasicSet<int, Direction>;
+
+        DirectedSet S1 = DirectedSet::from_unsorted({1, 3, 5}, Direction{true});
+        assert(*S1.begin() == 5);
+
+        // a value operand is ordered like the Set, not by a default Direction
+        DirectedSet S2 = 4 + S1;
+        assert(S2.cardinality() == 4 && *S2.begin() == 5 && *--S2.end() == 1);
+        assert(S2.key_comp().descending);
+
+        DirectedSet S3 = S1 - 3 + 0;
+        assert(S3.cardinality() == 3 && *S3.begin() == 5 && *--S3.end() == 0);
+        assert(S1 <= 7 + S1 && 3 + S1 == S1 && !(S1 < 3 + S1));
+    }
+
+    assert((BasicSet<int, Direction>::get_count_nodes() == 0));
+
+    /*****************************************************
+     * TEST PHASE 21                                      *
+     * Memory statistics                                  *
+     ******************************************************/
+    std::cout << "\nTEST PHASE 21: memory statistics\n";
+
+    {
+        Set::set_global_alloc_stats(true);
+        AllocStats before = Set::global_alloc_stats();
+        assert(before.live_blocks == 0);
+
+        Set S1{std::vector<int>{1, 3, 5}};
+        Set S2{std::vector<int>{2, 3, 4}};
+        S1.set_alloc_stats(true);
+
+        S1 += S2;       // allocates 2 and 4
+        S1 -= Set{3};   // frees 3
+        S1.insert(7);
+        assert(S1 == Set(std::vector<int>{1, 2, 4, 5, 7}));
+
+        assert(S1.is_member(4));         // visits 1 2 4
+        assert(S1.is_member(6) == false);  // visits 1 2 4 5 7
+
+        AllocStats local = S1.alloc_stats();
+        assert(local.allocations[AllocStats::Union] == 2);
+        assert(local.frees[AllocStats::Difference] == 1);
+        assert(local.allocations[AllocStats::Insert] == 1);
+        assert(local.total_allocations() == 3 && local.total_frees() == 1);
+        assert(local.live_blocks == 7 && local.live_bytes % 7 == 0 && local.peak_bytes >= local.live_bytes);
+        assert(local.member_queries == 2 && local.average_walk() == 4.0);
+
+        AllocStats global = Set::global_alloc_stats();
+        assert(global.live_blocks == 12 && static_cast<int>(global.live_blocks) == Set::get_count_nodes());
+        assert(global.allocations[AllocStats::Construct] - before.allocations[AllocStats::Construct] == 5 + 5 + 3 + 7);
+        assert(global.frees[AllocStats::Destroy] - before.frees[AllocStats::Destroy] == 3 + 7);
+        assert(global.total_allocations() - global.total_frees() == global.live_blocks);
+        assert(global.peak_bytes >= global.live_bytes);
+
+        std::ostringstream os{};
+        os << local;
+        assert(os.str().find("union +2/-0") != std::string::npos);
+
+        // periodic dump, and a last one when the dump is destroyed
+        std::ostringstream dumps{};
+        {
+            AllocStatsDump dump{"Set", &Set::global_alloc_stats, dumps, std::chrono::milliseconds{10}};
+            std::this_thread::sleep_for(std::chrono::milliseconds{35});
+        }
+
+        std::string out = dumps.str();
+        assert(out.find("Set: live ") == 0);
+        assert(std::count(out.begin(), out.end(), '\n') >= 2);
+
+        // off, only the live nodes are counted, the statistics of S1 are not affected
+        Set::set_global_alloc_stats(false);
+        before = Set::global_alloc_stats();
+
+        Set S3 = S1 + S2;
+        S3.erase(7);
+        assert(S3.is_member(3) && S1.is_member(3) == false);
+
+        global = Set::global_alloc_stats();
+        assert(global.live_blocks == before.live_blocks + 5 + 2 && static_cast<int>(global.live_blocks) == Set::get_count_nodes());
+        assert(global.total_allocations() == before.total_allocations() && global.total_frees() == before.total_frees());
+        assert(global.member_queries == before.member_queries);
+        assert(S1.alloc_stats().member_queries == 3);
+
+        // on again, the live bytes are those of the live nodes
+        Set::set_global_alloc_stats(true);
+        global = Set::global_alloc_stats();
+        assert(global.live_bytes == global.live_blocks * local.live_bytes / local.live_blocks);
+        assert(global.peak_bytes >= global.live_bytes);
+        Set::set_global_alloc_stats(false);
+    }
+
+    assert(Set::get_count_nodes() == 0);
+
+    /*****************************************************
+     * TEST PHASE 22                                      *
+     * Persistent sets                                    *
+     ******************************************************/
+    std::cout << "\nTEST PHASE 22: persistent sets\n";
+
+    {
+        std::vector<int> ids;
+        for (int i = 0; i < 1000; ++i) {
+            ids.push_back(2 * i);
+        }
+
+        PersistentSet v1{ids};
+        assert(v1.cardinality() == 1000 && v1.height() == 10);
+        assert(PersistentSet::get_count_nodes() == 1000);
+
+        PersistentSet v2 = v1;  // snapshot, no nodes allocated
+        assert(PersistentSet::get_count_nodes() == 1000 && v2 == v1);
+
+        assert(v2.insert(7) && v2.insert(7) == false);
+        assert(v2.is_member(7) && v1.is_member(7) == false);
+        assert(PersistentSet::get_count_nodes() <= 1000 + 12);  // one path copied
+
+        PersistentSet v3 = v2;
+        assert(v3.erase(500) && v3.erase(501) == false);
+        assert(v3.cardinality() == 1000 && v2.cardinality() == 1001 && v1.cardinality() == 1000);
+        assert(v2.is_member(500) && v3.is_member(500) == false);
+        assert(v1 != v3 && v1 - v3 == PersistentSet{500} && v3 - v1 == PersistentSet{7});
+
+        // batches, the previous versions are unchanged
+        PersistentSet v4 = v3;
+        assert(v4.insert_batch({3, 1, 3, 5, 0}) == 3);
+        assert(v4.erase_batch({1, 1, 2, 9}) == 2);
+        assert(v4.cardinality() == 1001 && v4.is_member(3) && v4.is_member(5) && v4.is_member(2) == false);
+        assert(v3.cardinality() == 1000 && v3.is_member(2));
+
+        // the tree stays balanced under sequential updates
+        PersistentSet V{};
+        for (int i = 0; i < 4096; ++i) {
+            V.insert(i);
+        }
+        assert(V.height() <= 13);
+        for (int i = 0; i < 4096; i += 2) {
+            V.erase(i);
+        }
+        assert(V.cardinality() == 2048 && V.height() <= 12);
+
+        // Set operations
+        PersistentSet A{std::vector<int>{1, 2, 3, 4}};
+        PersistentSet B{std::vector<int>{3, 4, 5}};
+        assert(A + B == PersistentSet(std::vector<int>{1, 2, 3, 4, 5}));
+        assert(A * B == PersistentSet(std::vector<int>{3, 4}));
+        assert(A - B == PersistentSet(std::vector<int>{1, 2}));
+        assert(A * B < A && A * B <= B && (A <= B) == false);
+        assert(PersistentSet{} + A == A && A - A == PersistentSet{});
+
+        // operations with large sets copy only the paths to the changed values
+        int nodes = PersistentSet::get_count_nodes();
+        PersistentSet U = v1 + PersistentSet{std::vector<int>{7, 4001}};
+        assert(U.cardinality() == 1002 && U.is_member(7) && U.is_member(4001) && U.height() <= 14);
+        assert(PersistentSet::get_count_nodes() - nodes <= 2 * 3 * 14);
+
+        nodes = PersistentSet::get_count_nodes();
+        PersistentSet I = v1 * v2;  // all nodes of v1 are shared
+        assert(I == v1 && PersistentSet::get_count_nodes() == nodes);
+        assert(v2 - v1 == PersistentSet{7} && (v1 - v1).is_empty());
+
+        assert(v1 <= v2 && (v2 <= v1) == false && v1 < U);
+        assert(PersistentSet(std::vector<int>{0, 1998}) <= v1);
+        assert((PersistentSet(std::vector<int>{0, 1}) <= v1) == false);
+
+        // compare with the operations on sorted vectors, for sets of different sizes
+        unsigned seed = 12345;
+        auto random_values = [&seed](size_t n) {
+            std::vector<int> values;
+            for (size_t i = 0; i < n; ++i) {
+                seed = seed * 1103515245u + 12345u;
+                values.push_back(static_cast<int>((seed >> 8) % 3000));
+            }
+            std::sort(values.begin(), values.end());
+            values.erase(std::unique(values.begin(), values.end()), values.end());
+            return values;
+        };
+
+        for (size_t n : {0, 1, 10, 300, 2000}) {
+            for (size_t m : {0, 3, 50, 1500}) {
+                std::vector<int> x = random_values(n);
+                std::vector<int> y = random_values(m);
+                PersistentSet X{x};
+                PersistentSet Y{y};
+
+                std::vector<int> r;
+                std::set_union(x.begin(), x.end(), y.begin(), y.end(), std::back_inserter(r));
+                PersistentSet R = X + Y;
+                assert(R.to_vector() == r && R.cardinality() == r.size());
+                assert(R.height() <= 1.45 * std::log2(r.size() + 2));
+
+                r.clear();
+                std::set_intersection(x.begin(), x.end(), y.begin(), y.end(), std::back_inserter(r));
+                R = X * Y;
+                assert(R.to_vector() == r && R.cardinality() == r.size());
+                assert(R.height() <= 1.45 * std::log2(r.size() + 2));
+
+                r.clear();
+                std::set_difference(x.begin(), x.end(), y.begin(), y.end(), std::back_inserter(r));
+                R = X - Y;
+                assert(R.to_vector() == r && R.cardinality() == r.size());
+                assert(R.height() <= 1.45 * std::log2(r.size() + 2));
+
+                bool subset = std::includes(y.begin(), y.end(), x.begin(), x.end());
+                assert((X <= Y) == subset && X * Y <= Y && X - Y <= X);
+            }
+        }
+
+        std::ostringstream os{};
+        os << (A - B) << " " << PersistentSet{};
+        assert(os.str() == "{ 1 2 } Set is empty!");
+
+        // conversion from and to Set
+        Set S{std::vector<int>{-5, 0, 5}};
+        PersistentSet P{S};
+        assert(P.to_vector() == std::vector<int>({-5, 0, 5}) && P.to_set() == S);
+
+        // other value types
+        BasicPersistentSet<std::string, std::greater<std::string>> names{"bob"};
+        names.insert("alice");
+        names.insert("carol");
+        assert(names.to_vector() == std::vector<std::string>({"carol", "bob", "alice"}));
+    }
+
+    assert(PersistentSet::get_count_nodes() == 0);
+
+    /*****************************************************
+     * TEST PHASE 23                                      *
+     * Sets from unsorted vectors                         *
+     ******************************************************/
+    std::cout << "\nTEST PHASE 23: sets from unsorted vectors\n";
+
+    {
+        Set S1 = Set::from_unsorted({5, -3, 5, 0, INT_MIN, -3, INT_MAX});
+        assert(S1 == Set(std::vector<int>{INT_MIN, -3, 0, 5, INT_MAX}));
+        assert(Set::from_unsorted({}).is_empty());
+
+        // radix sort, sequential and parallel, with repetitions and negative values
+        for (size_t n : {5000, 300000}) {
+            std::vector<int> A(n);
+            for (size_t i = 0; i < n; ++i) {
+                A[i] = static_cast<int>((i * 2654435761u) % 100003) - 50000;
+            }
+
+            std::vector<int> sorted = A;
+            std::sort(sorted.begin(), sorted.end());
+            sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+            Set S2 = Set::from_unsorted(A);
+            assert(S2.cardinality() == sorted.size() && S2 == Set(sorted));
+            assert(std::equal(S2.begin(), S2.end(), sorted.begin()));
+        }
+
+        // values differing in the high bytes only, and descending order
+        using DescendingSet = BasicSet<int64_t, std::greater<int64_t>>;
+        std::vector<int64_t> B;
+        for (int64_t i = -1000; i < 1000; ++i) {
+            B.push_back(i * (int64_t{1} << 40));
+            B.push_back(i * (int64_t{1} << 40));
+        }
+
+        DescendingSet S3 = DescendingSet::from_unsorted(B);
+        assert(S3.cardinality() == 2000 && *S3.begin() == 999 * (int64_t{1} << 40));
+        assert(std::is_sorted(S3.begin(), S3.end(), std::greater<int64_t>{}));
+
+        // unsigned chars, and comparison sort of other types
+        std::vector<unsigned char> C(2000);
+        for (size_t i = 0; i < C.size(); ++i) {
+            C[i] = static_cast<unsigned char>(255 - i % 256);
+        }
+        assert(BasicSet<unsigned char>::from_unsorted(C).cardinality() == 256);
+
+        using StringSet = BasicSet<std::string>;
+        StringSet S4 = StringSet::from_unsorted({"pear", "apple", "pear", "fig"});
+        assert(S4 == StringSet(std::vector<std::string>{"apple", "fig", "pear"}));
+
+        // insert_batch uses the same sort
+        Set S5{std::vector<int>{1, 2}};
+        std::vector<int> D(3000);
+        for (size_t i = 0; i < D.size(); ++i) {
+            D[i] = static_cast<int>(i % 1500);
+        }
+        assert(S5.insert_batch(D) == 1498 && S5.cardinality() == 1500);
+    }
+
+    assert(Set::get_count_nodes() == 0);
+
+    /*****************************************************
+     * TEST PHASE 24                                      *
+     * Binary files and mapped sets                       *
+     ******************************************************/
+    std::cout << "\nTEST PHASE 24: binary files and mapped sets\n";
+
+    {
+        const std::string path = "set_io_test.bin";
+
+        std::vector<int> A;
+        for (int i = -3000; i < 3000; i += 3) {
+            A.push_back(i);
+        }
+        A.push_back(1000000);
+        A.push_back(INT_MAX);
+        A.insert(A.begin(), INT_MIN);
+        Set S1{A};
+
+        assert(save_set(S1, path));
+
+        Set S2{};
+        assert(load_set(path, S2) && S2 == S1);
+
+        MappedSet M{path};
+        assert(M.is_open() && M.cardinality() == S1.cardinality() && M.number_of_blocks() == 16);
+        assert(std::equal(M.begin(), M.end(), S1.begin(), S1.end()));
+
+        for (int val : {INT_MIN, INT_MIN + 1, -3000, -2999, 0, 2997, 2998, 999999, 1000000, INT_MAX, INT_MAX - 1}) {
+            assert(M.is_member(val) == S1.is_member(val));
+        }
+        assert(M.validate());
+
+        // the blocks are checked by whichever thread decodes them first
+        {
+            MappedSet shared{path};
+            std::vector<std::thread> readers;
+            for (int t = 0; t < 4; ++t) {
+                readers.emplace_back([&shared, &A]() {
+                    for (int val : A) {
+                        assert(shared.is_member(val));
+                    }
+                });
+            }
+            for (std::thread& reader : readers) {
+                reader.join();
+            }
+            assert(shared.validate());
+        }
+
+        // expressions with mapped operands, evaluated without decoding the file into a Set
+        Set S3{std::vector<int>{-3000, -2, 0, 1, 1000000}};
+        Set S4 = (M + S3) - S1;
+        assert(S4 == Set(std::vector<int>{-2, 1}));
+        assert(M * S3 == Set(std::vector<int>{-3000, 0, 1000000}));
+        assert((M - 0) * S3 == Set(std::vector<int>{-3000, 1000000}));
+        assert(M.to_set() == S1);
+
+        // dense sets take about one byte per value
+        std::ostringstream bin{};
+        std::vector<int> B(10000);
+        for (int i = 0; i < 10000; ++i) {
+            B[i] = 2 * i;
+        }
+        assert(write_set(bin, Set{B}));
+        assert(bin.str().size() < 32 + 79 * 16 + 10000);
+
+        // empty sets, and files which are not Set files
+        assert(save_set(Set{}, path));
+        assert(M.open(path) && M.is_empty() && M.begin() == M.end() && M.is_member(0) == false);
+
+        std::ostringstream os{};
+        os << M << " " << (M + 5);
+        assert(os.str() == "Set is empty! { 5 }");
+
+        {
+            std::ofstream garbage{path, std::ios::binary};
+            garbage << "not a set";
+        }
+        assert(M.open(path) == false && M.is_open() == false);
+        assert(load_set(path, S2) == false && S2 == S1);
+        assert(MappedSet{"no_such_file.bin"}.is_open() == false);
+
+        // corrupted blocks are found when they are first decoded, or by validate()
+        auto corrupt = [&path](const Set& S, uint32_t block_size, size_t pos, const std::string& bytes) {
+            std::ostringstream out{};
+            assert(write_set(out, S, block_size));
+
+            std::string file = out.str();
+            file.replace(pos, bytes.size(), bytes);
+            std::ofstream{path, std::ios::binary} << file;
+        };
+
+        corrupt(Set{B}, 128, 32 + 79 * 16 + 500, "\xff");  // a varint of block 3 runs into the next one
+        assert(M.open(path) && M.is_member(2) && M.is_member(2 * 128 * 3 + 2) == false);
+        assert(std::distance(M.begin(), M.end()) == 128 * 3 && M.is_member(2 * 128 * 4) && M.validate() == false);
+        assert(load_set(path, S2) == false && S2 == S1);
+
+        corrupt(Set{B}, 128, 32 + 79 * 16 + 10000 - 80, "\xff");  // the last varint is truncated
+        assert(M.open(path) && M.validate() == false && load_set(path, S2) == false && S2 == S1);
+
+        Set S5{std::vector<int>{0, (1 << 28) + 1}};  // one delta of 5 bytes
+        corrupt(S5, 128, 32 + 16, std::string{"\xff\xff\xff\xff\x0f"});  // delta 2^32 - 1 wraps around to 0
+        assert(M.open(path) && M.validate() == false && load_set(path, S2) == false && S2 == S1);
+
+        corrupt(Set{std::vector<int>{1, 2, 3, 4}}, 2, 32 + 2 * 16, "\x05");  // 1 7 | 3 4
+        assert(M.open(path) && M.validate() == false && load_set(path, S2) == false && S2 == S1);
+
+        corrupt(Set{std::vector<int>{1, 2, 3, 4}}, 2, 32 + 2 * 16, "\x00");  // not corrupted
+        assert(M.open(path) && M.validate() && load_set(path, S2) && S2 == Set(std::vector<int>{1, 2, 3, 4}));
+
+        std::remove(path.c_str());
+    }
+
+    assert(Set::get_count_nodes() == 0);
+
+    /*****************************************************
+     * TEST PHASE 25                                      *
+     * Symmetric difference, split_at and extract_if      *
+     ******************************************************/
+    std::cout << "\nTEST PHASE 25: symmetric difference, split and extract\n";
+
+    {
+        Set::set_global_alloc_stats(true);
+
+        Set S1{std::vector<int>{1, 3, 5, 7, 9}};
+        Set S2{std::vector<int>{2, 3, 4, 9, 10, 11}};
+        Set S3 = (S1 - S2) + (S2 - S1);
+
+        assert((S1 ^ S2) == S3);
+        assert(Set(S1 ^ S1).is_empty() && (S1 ^ Set{}) == S1 && (S1 ^ 4) == Set(std::vector<int>{1, 3, 4, 5, 7, 9}));
+
+        Set S4 = S1;
+        S4 ^= S2;
+        assert(S4 == S3 && S4.cardinality() == 7);
+        S4 ^= S2;
+        assert(S4 == S1);
+        S4 ^= S4;
+        assert(S4.is_empty());
+
+        std::ostringstream os{};
+        os << (Set{std::vector<int>{1, 2}} ^ Set{std::vector<int>{2, 3}});
+        assert(os.str() == "{ 1 3 }");
+
+        // symmetric difference of large sets
+        std::vector<int> A;
+        std::vector<int> B;
+        for (int i = 0; i < 60000; ++i) {
+            A.push_back(2 * i);
+            B.push_back(3 * i);
+        }
+
+        Set S5{A};
+        Set S6{B};
+        Set S7 = (S5 - S6) + (S6 - S5);
+        S5 ^= S6;
+        assert(S5 == S7 && S5.cardinality() == 60000 + 60000 - 2 * 20000);
+
+        // split_at relinks the nodes, none is allocated nor freed
+        Set S8{std::vector<int>{1, 3, 5, 7}};
+        int nodes = Set::get_count_nodes();
+
+        Set upper = S8.split_at(5);
+        assert(Set::get_count_nodes() == nodes + 2);  // dummy nodes of upper
+        assert(S8 == Set(std::vector<int>{1, 3}) && upper == Set(std::vector<int>{5, 7}));
+        assert(S8.split_at(4).is_empty() && S8.cardinality() == 2);
+        assert(S8.split_at(0) == Set(std::vector<int>{1, 3}) && S8.is_empty());
+
+        upper.insert(9);
+        assert(*(--upper.end()) == 9 && *upper.begin() == 5);
+
+        // extract_if keeps both lists sorted
+        Set S9{std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8}};
+        S9.set_bloom_filter(0.01);
+        Set even = S9.extract_if([](int v) { return v % 2 == 0; });
+        assert(even == Set(std::vector<int>{2, 4, 6, 8}) && S9 == Set(std::vector<int>{1, 3, 5, 7}));
+        assert(S9.is_member(4) == false && even.is_member(4));
+        assert(S9.extract_if([](int v) { return v > 100; }).is_empty() && S9.cardinality() == 4);
+
+        // copy-on-write copies are not affected
+        Set S10{std::vector<int>{1, 2, 3}};
+        S10.set_copy_on_write(true);
+        Set S11 = S10;
+        Set S12 = S11.split_at(2);
+        assert(S10 == Set(std::vector<int>{1, 2, 3}) && S11 == Set{1} && S12 == Set(std::vector<int>{2, 3}));
+
+        // the moved-from Set is empty
+        Set S13{std::move(S12)};
+        assert(S12.is_empty() && S13.cardinality() == 2);
+
+        AllocStats stats = Set::global_alloc_stats();
+        assert(stats.allocations[AllocStats::SymmetricDifference] > 0);
+        Set::set_global_alloc_stats(false);
+    }
+
+    assert(Set::get_count_nodes() == 0);
+
     std::cout << "Success!!\n";
 }
@@ -0,0 +1,453 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <set>
+#include <unordered_set>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <optional>
+#include <atomic>
+#include <cstdlib>
+#include <string>
+#include <new>
+#include <iterator>
+#include <cassert>  //assert
+#include <cstdint>
+#include <memory>
+
+#include "set.h"
+
+/* *************************************************************** *
+ * Benchmark of the Set operations                                 *
+ *                                                                 *
+ * Set is compared with std::set, std::unordered_set and sorted    *
+ * std::vector (std::set_union & co) for several sizes,            *
+ * overlap ratios and size skews                                   *
+ *                                                                 *
+ * Usage: benchmark [size ...]                                     *
+ *   e.g. benchmark 100 10000 1000000 100000000                    *
+ *   default sizes 1e2 .. 1e6                                      *
+ *                                                                 *
+ * Build from Lab 2 with optimizations, e.g.                       *
+ *   g++ -std=c++17 -O2 -pthread -I. mains/benchmark.cpp           *
+ *       sketch.cpp bloom.cpp alloc_stats.cpp -o benchmark         *
+ * *************************************************************** */
+
+/* ******************************************** *
+ * Counting of the allocations                  *
+ * ******************************************** */
+
+namespace {
+    std::atomic<size_t> allocations{0};  // number of calls to operator new
+    std::atomic<size_t> live_bytes{0};   // bytes currently allocated
+
+    // Every block starts with a header storing its size
+    const size_t header = alignof(std::max_align_t);
+
+    // Results of the queries are accumulated here, so that they are not optimized away
+    volatile size_t sink = 0;
+}
+
+void* operator new(size_t n) {
+    char* p = static_cast<char*>(std::malloc(n + header));
+    if (p == nullptr) throw std::bad_alloc{};
+
+    *reinterpret_cast<size_t*>(p) = n;
+    ++allocations;
+    live_bytes += n;
+
+    return p + header;
+}
+
+void operator delete(void* ptr) noexcept {
+    if (ptr == nullptr) return;
+
+    // The address of the header is computed on integers, since it lies before the block seen by the caller
+    void* p = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(ptr) - header);
+    live_bytes -= *static_cast<size_t*>(p);
+    std::free(p);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+/* ******************************************** *
+ * Containers under test                        *
+ * Every backend offers the same operations     *
+ * ******************************************** */
+
+struct ListSetBackend {
+    using Container = Set;
+    static constexpr const char* name = "Set";
+
+    static Container build(const std::vector<int>& v) {
+        return Set{v};
+    }
+
+    static bool contains(const Container& c, int x) {
+        return c.is_member(x);
+    }
+
+    static void unite(Container& a, const Container& b) {
+        a += b;
+    }
+
+    static void intersect(Container& a, const Container& b) {
+        a *= b;
+    }
+
+    static void subtract(Container& a, const Container& b) {
+        a -= b;
+    }
+
+    static bool subset(const Container& a, const Container& b) {
+        return a <= b;
+    }
+};
+
+struct StdSetBackend {
+    using Container = std::set<int>;
+    static constexpr const char* name = "std::set";
+
+    static Container build(const std::vector<int>& v) {
+        return Container(v.begin(), v.end());
+    }
+
+    static bool contains(const Container& c, int x) {
+        return c.count(x) > 0;
+    }
+
+    static void unite(Container& a, const Container& b) {
+        a.insert(b.begin(), b.end());
+    }
+
+    // Walk both trees in order, erasing the values of a missing in b
+    static void intersect(Container& a, const Container& b) {
+        auto it_b = b.begin();
+
+        for (auto it = a.begin(); it != a.end();) {
+            while (it_b != b.end() && *it_b < *it) ++it_b;
+
+            if (it_b == b.end() || *it < *it_b) it = a.erase(it);
+            else ++it;
+        }
+    }
+
+    static void subtract(Container& a, const Container& b) {
+        for (int x : b) a.erase(x);
+    }
+
+    static bool subset(const Container& a, const Container& b) {
+        return std::includes(b.begin(), b.end(), a.begin(), a.end());
+    }
+};
+
+struct UnorderedSetBackend {
+    using Container = std::unordered_set<int>;
+    static constexpr const char* name = "std::unordered_set";
+
+    static Container build(const std::vector<int>& v) {
+        return Container(v.begin(), v.end());
+    }
+
+    static bool contains(const Container& c, int x) {
+        return c.count(x) > 0;
+    }
+
+    static void unite(Container& a, const Container& b) {
+        a.insert(b.begin(), b.end());
+    }
+
+    static void intersect(Container& a, const Container& b) {
+        for (auto it = a.begin(); it != a.end();) {
+            if (b.count(*it) == 0) it = a.erase(it);
+            else ++it;
+        }
+    }
+
+    static void subtract(Container& a, const Container& b) {
+        for (int x : b) a.erase(x);
+    }
+
+    static bool subset(const Container& a, const Container& b) {
+        if (a.size() > b.size()) return false;
+
+        for (int x : a) {
+            if (b.count(x) == 0) return false;
+        }
+        return true;
+    }
+};
+
+struct SortedVectorBackend {
+    using Container = std::vector<int>;
+    static constexpr const char* name = "sorted std::vector";
+
+    static Container build(const std::vector<int>& v) {
+        return v;
+    }
+
+    static bool contains(const Container& c, int x) {
+        return std::binary_search(c.begin(), c.end(), x);
+    }
+
+    static void unite(Container& a, const Container& b) {
+        Container r;
+        r.reserve(a.size() + b.size());
+        std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(r));
+        a.swap(r);
+    }
+
+    static void intersect(Container& a, const Container& b) {
+        Container r;
+        r.reserve(std::min(a.size(), b.size()));
+        std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(r));
+        a.swap(r);
+    }
+
+    static void subtract(Container& a, const Container& b) {
+        Container r;
+        r.reserve(a.size());
+        std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(r));
+        a.swap(r);
+    }
+
+    static bool subset(const Container& a, const Container& b) {
+        return std::includes(b.begin(), b.end(), a.begin(), a.end());
+    }
+};
+
+/* ******************************************** *
+ * Measurements                                 *
+ * ******************************************** */
+
+using Clock = std::chrono::steady_clock;
+
+// Result of one operation: time and allocations per call
+struct Sample {
+    double ns = 0.0;
+    double allocs = 0.0;
+};
+
+// Accumulate the time and allocations of the calls to f, excluding the setup
+struct Meter {
+    double ns = 0.0;
+    size_t allocs = 0;
+    size_t calls = 0;
+
+    template <typename F>
+    void measure(F&& f) {
+        size_t a0 = allocations;
+        auto t0 = Clock::now();
+
+        f();
+
+        auto t1 = Clock::now();
+        allocs += allocations - a0;
+        ns += std::chrono::duration<double, std::nano>(t1 - t0).count();
+        ++calls;
+    }
+
+    Sample result(size_t ops_per_call = 1) const {
+        double n = static_cast<double>(calls * ops_per_call);
+        return Sample{ns / n, allocs / n};
+    }
+};
+
+// Input of a benchmark: operands A and B of sizes n and m, and membership queries
+struct Workload {
+    std::vector<int> A;
+    std::vector<int> B;
+    std::vector<int> queries;  // half present in A, half absent
+};
+
+/** Create sorted operands A, |A| = n, and B, |B| = m
+ *
+ * \param overlap fraction of the values of B that also belong to A
+ * The values of A are even, the values of B not in A are odd
+ *
+ */
+Workload make_workload(size_t n, size_t m, double overlap, size_t num_queries, std::mt19937& rng) {
+    Workload w;
+
+    std::uniform_int_distribution<int> dist(0, static_cast<int>(std::min<size_t>(4 * (n + m), 1u << 30)));
+
+    std::unordered_set<int> a_values;
+    while (a_values.size() < n) {
+        a_values.insert(dist(rng) & ~1);
+    }
+    w.A.assign(a_values.begin(), a_values.end());
+
+    size_t common = std::min(n, static_cast<size_t>(overlap * m));
+    std::vector<int> sample;
+    std::sample(w.A.begin(), w.A.end(), std::back_inserter(sample), common, rng);
+
+    std::unordered_set<int> b_values(sample.begin(), sample.end());
+    while (b_values.size() < m) {
+        b_values.insert(dist(rng) | 1);
+    }
+    w.B.assign(b_values.begin(), b_values.end());
+
+    for (size_t i = 0; i < num_queries; ++i) {
+        int x = w.A[rng() % w.A.size()];
+        w.queries.push_back((i % 2 == 0) ? x : x + 1);
+    }
+
+    std::sort(w.A.begin(), w.A.end());
+    std::sort(w.B.begin(), w.B.end());
+
+    return w;
+}
+
+// Print one line of the report
+void report(const char* container, const char* op, const Workload& w, double overlap, const Sample& s,
+            double bytes_per_element = -1.0) {
+    std::cout << std::left << std::setw(20) << container << std::setw(12) << op << std::right
+              << std::setw(11) << w.A.size() << std::setw(11) << w.B.size() << std::fixed << std::setprecision(2)
+              << std::setw(9) << overlap << std::setw(14) << std::setprecision(1) << s.ns << std::setw(12)
+              << std::setprecision(2) << s.allocs;
+
+    if (bytes_per_element >= 0.0) {
+        std::cout << std::setw(12) << std::setprecision(1) << bytes_per_element;
+    }
+    std::cout << "\n";
+}
+
+/** Run all operations of one backend on workload w
+ *
+ * Every operation is repeated until about 50 ms have been spent, at least once
+ * Binary operations work on a fresh copy of A, and the copy is not timed
+ *
+ */
+template <typename Backend>
+void run(const Workload& w, double overlap) {
+    using Container = typename Backend::Container;
+    const double budget = 5e7;  // ns per operation
+
+    // Construction from a sorted vector, and memory per element
+    {
+        Meter meter;
+        double bytes = 0.0;
+
+        do {
+            size_t before = live_bytes;
+            std::unique_ptr<Container> c;
+
+            // new Container(prvalue) constructs in place, without copying the container
+            meter.measure([&]() { c.reset(new Container(Backend::build(w.A))); });
+            bytes = static_cast<double>(live_bytes - before) / w.A.size();
+        } while (meter.ns < budget);
+
+        report(Backend::name, "build", w, overlap, meter.result(), bytes);
+    }
+
+    const Container a = Backend::build(w.A);
+    const Container b = Backend::build(w.B);
+
+    // Membership queries
+    {
+        Meter meter;
+        size_t found = 0;
+
+        do {
+            meter.measure([&]() {
+                for (int x : w.queries) found += Backend::contains(a, x);
+            });
+        } while (meter.ns < budget);
+
+        report(Backend::name, "is_member", w, overlap, meter.result(w.queries.size()));
+        sink = sink + found;
+    }
+
+    auto binary = [&](const char* op, void (*f)(Container&, const Container&)) {
+        Meter meter;
+
+        do {
+            Container c = a;
+            meter.measure([&]() { f(c, b); });
+        } while (meter.ns < budget);
+
+        report(Backend::name, op, w, overlap, meter.result());
+    };
+
+    binary("+=", &Backend::unite);
+    binary("*=", &Backend::intersect);
+    binary("-=", &Backend::subtract);
+
+    // Subset test of A*B in A: the answer is true, so the whole of A*B is walked
+    {
+        Container c = a;
+        Backend::intersect(c, b);
+
+        Meter meter;
+        bool result = true;
+
+        do {
+            meter.measure([&]() { result = result && Backend::subset(c, a); });
+        } while (meter.ns < budget);
+
+        report(Backend::name, "<=", w, overlap, meter.result());
+        if (!result) std::cout << "unexpected subset result\n";
+    }
+
+    // Copy and destruction
+    {
+        Meter copy_meter;
+        Meter destroy_meter;
+
+        do {
+            std::optional<Container> c;
+
+            copy_meter.measure([&]() { c.emplace(a); });
+            destroy_meter.measure([&]() { c.reset(); });
+        } while (copy_meter.ns + destroy_meter.ns < budget);
+
+        report(Backend::name, "copy", w, overlap, copy_meter.result());
+        report(Backend::name, "destroy", w, overlap, destroy_meter.result());
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<size_t> sizes;
+
+    for (int i = 1; i < argc; ++i) {
+        sizes.push_back(static_cast<size_t>(std::stod(argv[i])));
+    }
+
+    if (sizes.empty()) {
+        sizes = {100, 1000, 10000, 100000, 1000000};
+    }
+
+    const std::vector<double> overlaps{0.0, 0.5, 1.0};  // fraction of the values of B also in A
+    const std::vector<size_t> skews{1, 100};            // |A| / |B|
+
+    std::mt19937 rng{2020};
+
+    std::cout << std::left << std::setw(20) << "container" << std::setw(12) << "operation" << std::right
+              << std::setw(11) << "|A|" << std::setw(11) << "|B|" << std::setw(9) << "overlap"
+              << std::setw(14) << "ns/op" << std::setw(12) << "allocs/op" << std::setw(12) << "bytes/elem"
+              << "\n";
+
+    for (size_t n : sizes) {
+        for (size_t skew : skews) {
+            size_t m = std::max<size_t>(1, n / skew);
+            if (skew > 1 && m == n) continue;
+
+            for (double overlap : overlaps) {
+                // Set::is_member walks the list, so the number of queries shrinks with the size
+                size_t num_queries = std::max<size_t>(2, std::min<size_t>(1000, 100000000 / n));
+                Workload w = make_workload(n, m, overlap, num_queries, rng);
+
+                run<ListSetBackend>(w, overlap);
+                run<StdSetBackend>(w, overlap);
+                run<UnorderedSetBackend>(w, overlap);
+                run<SortedVectorBackend>(w, overlap);
+                std::cout << "\n";
+            }
+        }
+    }
+
+    assert(Set::get_count_nodes() == 0);
+}
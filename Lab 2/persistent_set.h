@@ -0,0 +1,831 @@
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+#include "set.h"
+
+#pragma once
+
+/** Class to represent a persistent (versioned) Set of values of type T
+ *
+ * BasicPersistentSet is implemented as an AVL tree of immutable nodes shared by all versions
+ * Copying a PersistentSet is O(1) and gives a snapshot of the current version:
+ * insert, erase, +=, -=, *= and the batches never modify a node, they copy the
+ * O(log n) nodes on the path to the modified value and share all other subtrees
+ * with the previous versions, e.g.
+ *   PersistentSet v1{ids};
+ *   PersistentSet v2 = v1;  // snapshot
+ *   v2.insert(42);          // v1 is unchanged, v2 allocates O(log n) nodes
+ *
+ * A node is deallocated when the last version referring to it is destroyed
+ * Versions can be read by several threads at the same time, as long as no thread modifies the same object
+ *
+ * is_member, insert and erase are O(log n)
+ * +=, -= and *= split one tree at the values of the other and join the pieces:
+ * with m <= n values in the smaller operand they are O(m log(n/m + 1)), i.e. at most O(n + m),
+ * and the subtrees left unchanged, or shared by both operands, are kept without being walked
+ */
+template <typename T, typename Compare = std::less<T>>
+class BasicPersistentSet {
+public:
+	using value_type = T;
+	using key_compare = Compare;
+	using size_type = size_t;
+
+	// Default constructor: create an empty PersistentSet
+	BasicPersistentSet();
+
+	// Create an empty PersistentSet ordered by comp
+	explicit BasicPersistentSet(const Compare& comp);
+
+	// Conversion constructor: Convert val into a singleton {val}
+	BasicPersistentSet(const T& val);
+
+	/** Constructor to create a PersistentSet from a sorted vector
+	 *
+	 * \param v vector sorted by Compare, without repetitions
+	 * A perfectly balanced tree is built in linear time
+	 *
+	 */
+	BasicPersistentSet(const std::vector<T>& v);
+
+	/** Constructor to create a PersistentSet with all values in Set S
+	 *
+	 */
+	template <typename Allocator>
+	explicit BasicPersistentSet(const BasicSet<T, Compare, Allocator>& S);
+
+	// Copying gives a snapshot in O(1), the nodes are shared
+	BasicPersistentSet(const BasicPersistentSet&) = default;
+	BasicPersistentSet& operator=(const BasicPersistentSet&) = default;
+
+	/** Test whether the PersistentSet is empty
+	 *
+	 */
+	bool is_empty() const;
+
+	/** Count the number of values stored in the PersistentSet
+	 *
+	 */
+	size_t cardinality() const;
+
+	/** Return the height of the tree, 0 if the PersistentSet is empty
+	 *
+	 * At most 1.44 log2(n + 2)
+	 *
+	 */
+	int height() const;
+
+	/** Test whether val belongs to the PersistentSet
+	 *
+	 */
+	bool is_member(const T& val) const;
+
+	/** Transform the PersistentSet into an empty set
+	 *
+	 * Other versions are not affected
+	 *
+	 */
+	void make_empty();
+
+	/** Insert val into the PersistentSet
+	 *
+	 * The O(log n) nodes on the path to val are copied, all other nodes are shared
+	 * Return true if val was inserted, false if it already belonged to the PersistentSet
+	 *
+	 */
+	bool insert(const T& val);
+
+	/** Remove val from the PersistentSet
+	 *
+	 * Return true if val was removed, false if it did not belong to the PersistentSet
+	 *
+	 */
+	bool erase(const T& val);
+
+	/** Insert all values in a batch
+	 *
+	 * \param values unsorted values, possibly with repetitions
+	 * The k values are sorted into a tree, which is merged as by +=
+	 * Return number of values inserted
+	 *
+	 */
+	size_t insert_batch(std::vector<T> values);
+
+	/** Remove all values in a batch
+	 *
+	 * \param values unsorted values, possibly with repetitions
+	 * The k values are sorted into a tree, which is removed as by -=
+	 * Return number of values removed
+	 *
+	 */
+	size_t erase_batch(std::vector<T> values);
+
+	/** Return the values, in increasing order
+	 *
+	 */
+	std::vector<T> to_vector() const;
+
+	/** Return a Set with the same values
+	 *
+	 */
+	BasicSet<T, Compare> to_set() const;
+
+	/** Test whether PersistentSet *this is a subset of PersistentSet b
+	 *
+	 * O(min(n log m, n + m)) for n values in *this and m in b, without copying the values
+	 *
+	 */
+	bool operator<=(const BasicPersistentSet& b) const;
+
+	/** Test whether PersistentSet *this and b represent the same set
+	 *
+	 * A version and an unmodified snapshot of it share their root and are compared in O(1)
+	 *
+	 */
+	bool operator==(const BasicPersistentSet& b) const;
+
+	/** Test whether PersistentSet *this and b represent different sets
+	 *
+	 */
+	bool operator!=(const BasicPersistentSet& b) const;
+
+	/** Test whether PersistentSet *this is a strict subset of PersistentSet b
+	 *
+	 */
+	bool operator<(const BasicPersistentSet& b) const;
+
+	/** Modify *this such that it becomes the union of *this with S
+	 *
+	 * Other versions are not affected
+	 *
+	 */
+	BasicPersistentSet& operator+=(const BasicPersistentSet& S);
+
+	/** Modify *this such that it becomes the intersection of *this with S
+	 *
+	 */
+	BasicPersistentSet& operator*=(const BasicPersistentSet& S);
+
+	/** Modify *this such that it becomes the difference between *this and S
+	 *
+	 */
+	BasicPersistentSet& operator-=(const BasicPersistentSet& S);
+
+	/** Return the ordering of the values
+	 *
+	 */
+	Compare key_comp() const;
+
+	/** Return number of existing nodes in the current program, shared nodes are counted once
+	 *
+	 * Used for debug purposes
+	 *
+	 */
+	static int get_count_nodes();
+
+private:
+	struct Node;
+
+	using NodePtr = std::shared_ptr<const Node>;
+
+	class Cursor;
+
+	NodePtr root;    // root of the current version, nullptr if empty
+	size_t counter;  // number of values in the PersistentSet
+	Compare comp;    // ordering of the values
+
+	static std::atomic<int> count_nodes;  // number of existing nodes
+
+	bool equal(const T& a, const T& b) const;
+
+	static int height(const NodePtr& t);
+
+	static size_t size(const NodePtr& t);
+
+	static NodePtr make_node(const NodePtr& left, const T& val, const NodePtr& right);
+
+	static NodePtr balance(const NodePtr& left, const T& val, const NodePtr& right);
+
+	static NodePtr join(const NodePtr& left, const T& val, const NodePtr& right);
+
+	static NodePtr join(const NodePtr& left, const NodePtr& right);
+
+	bool split(const NodePtr& t, const T& val, NodePtr& left, NodePtr& right) const;
+
+	NodePtr unite(const NodePtr& t1, const NodePtr& t2) const;
+
+	NodePtr intersect(const NodePtr& t1, const NodePtr& t2) const;
+
+	NodePtr subtract(const NodePtr& t1, const NodePtr& t2) const;
+
+	bool all_members(const Node* t, const BasicPersistentSet& b) const;
+
+	static NodePtr build(const std::vector<T>& v, size_t first, size_t last);
+
+	NodePtr insert(const NodePtr& t, const T& val, bool& inserted) const;
+
+	NodePtr erase(const NodePtr& t, const T& val, bool& erased) const;
+
+	static NodePtr erase_min(const NodePtr& t, T& min);
+
+	static void to_vector(const NodePtr& t, std::vector<T>& v);
+
+	void sort_unique(std::vector<T>& v) const;
+
+	/* ***************************** *
+	 * Overloaded Global Operators   *
+	 * ***************************** */
+
+	/** Overloaded operator<<
+	 *
+	 * Values are written in increasing order, as for class BasicSet
+	 *
+	 */
+	friend std::ostream& operator<<(std::ostream& os, const BasicPersistentSet& b) {
+		if (b.is_empty()) {
+			os << "Set is empty!";
+		} else {
+			os << "{ ";
+			for (const T& val : b.to_vector()) {
+				os << val << " ";
+			}
+
+			os << "}";
+		}
+
+		return os;
+	}
+
+	// Overloaded operator+: union S1+S2
+	friend BasicPersistentSet operator+(BasicPersistentSet S1, const BasicPersistentSet& S2) {
+		return (S1 += S2);
+	}
+
+	// Overloaded operator*: intersection S1*S2
+	friend BasicPersistentSet operator*(BasicPersistentSet S1, const BasicPersistentSet& S2) {
+		return (S1 *= S2);
+	}
+
+	// Overloaded operator-: difference S1-S2
+	friend BasicPersistentSet operator-(BasicPersistentSet S1, const BasicPersistentSet& S2) {
+		return (S1 -= S2);
+	}
+};
+
+// Persistent Set of ints
+using PersistentSet = BasicPersistentSet<int>;
+
+/* ******************************************************** *
+ * Immutable tree node, shared by all versions referring     *
+ * to it. Nodes are never modified after construction        *
+ * ******************************************************** */
+
+template <typename T, typename Compare>
+struct BasicPersistentSet<T, Compare>::Node {
+	Node(const NodePtr& left, const T& val, const NodePtr& right)
+		: value{val}, height{1 + std::max(BasicPersistentSet::height(left), BasicPersistentSet::height(right))},
+		  size{1 + BasicPersistentSet::size(left) + BasicPersistentSet::size(right)},
+		  left{left}, right{right} {
+		++count_nodes;
+	}
+
+	~Node() {
+		--count_nodes;
+	}
+
+	const T value;
+	const int height;  // height of the subtree, 1 for a leaf
+	const size_t size;  // number of values in the subtree
+	const NodePtr left;
+	const NodePtr right;
+};
+
+/* ******************************************************** *
+ * In-order cursor over a subtree, without copying values    *
+ * ******************************************************** */
+
+template <typename T, typename Compare>
+class BasicPersistentSet<T, Compare>::Cursor {
+public:
+	explicit Cursor(const Node* t) {
+		push_left(t);
+	}
+
+	bool done() const {
+		return path.empty();
+	}
+
+	const T& value() const {
+		return path.back()->value;
+	}
+
+	void next() {
+		const Node* t = path.back();
+		path.pop_back();
+		push_left(t->right.get());
+	}
+
+private:
+	std::vector<const Node*> path;  // nodes whose value and right subtree are still to be visited
+
+	void push_left(const Node* t) {
+		for (; t != nullptr; t = t->left.get()) {
+			path.push_back(t);
+		}
+	}
+};
+
+/*****************************************************
+ * Implementation of class BasicPersistentSet         *
+ ******************************************************/
+
+template <typename T, typename Compare>
+std::atomic<int> BasicPersistentSet<T, Compare>::count_nodes{0};
+
+// Default constructor
+template <typename T, typename Compare>
+BasicPersistentSet<T, Compare>::BasicPersistentSet() : BasicPersistentSet{Compare{}} {
+}
+
+// Empty PersistentSet with an ordering
+template <typename T, typename Compare>
+BasicPersistentSet<T, Compare>::BasicPersistentSet(const Compare& comp) : root{nullptr}, counter{0}, comp{comp} {
+}
+
+// Conversion constructor
+template <typename T, typename Compare>
+BasicPersistentSet<T, Compare>::BasicPersistentSet(const T& val) : BasicPersistentSet{} {
+	root = make_node(nullptr, val, nullptr);
+	counter = 1;
+}
+
+// Constructor to create a PersistentSet from a sorted vector
+template <typename T, typename Compare>
+BasicPersistentSet<T, Compare>::BasicPersistentSet(const std::vector<T>& v) : BasicPersistentSet{} {
+	root = build(v, 0, v.size());
+	counter = v.size();
+}
+
+// Constructor to create a PersistentSet from a Set
+template <typename T, typename Compare>
+template <typename Allocator>
+BasicPersistentSet<T, Compare>::BasicPersistentSet(const BasicSet<T, Compare, Allocator>& S)
+	: BasicPersistentSet{S.key_comp()} {
+	std::vector<T> v(S.begin(), S.end());
+
+	root = build(v, 0, v.size());
+	counter = v.size();
+}
+
+// Test whether the PersistentSet is empty
+template <typename T, typename Compare>
+bool BasicPersistentSet<T, Compare>::is_empty() const {
+	return counter == 0;
+}
+
+// Number of values
+template <typename T, typename Compare>
+size_t BasicPersistentSet<T, Compare>::cardinality() const {
+	return counter;
+}
+
+// Height of the tree
+template <typename T, typename Compare>
+int BasicPersistentSet<T, Compare>::height() const {
+	return height(root);
+}
+
+// Test whether val belongs to the PersistentSet
+template <typename T, typename Compare>
+bool BasicPersistentSet<T, Compare>::is_member(const T& val) const {
+	const Node* t = root.get();
+
+	while (t != nullptr) {
+		if (comp(val, t->value)) {
+			t = t->left.get();
+		} else if (comp(t->value, val)) {
+			t = t->right.get();
+		} else {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Make the PersistentSet empty, nodes still referred to by other versions are kept
+template <typename T, typename Compare>
+void BasicPersistentSet<T, Compare>::make_empty() {
+	root = nullptr;
+	counter = 0;
+}
+
+// Insert val, copying the path to it
+template <typename T, typename Compare>
+bool BasicPersistentSet<T, Compare>::insert(const T& val) {
+	bool inserted = false;
+
+	NodePtr t = insert(root, val, inserted);
+
+	if (inserted) {
+		root = std::move(t);
+		++counter;
+	}
+	return inserted;
+}
+
+// Remove val, copying the path to it
+template <typename T, typename Compare>
+bool BasicPersistentSet<T, Compare>::erase(const T& val) {
+	bool erased = false;
+
+	NodePtr t = erase(root, val, erased);
+
+	if (erased) {
+		root = std::move(t);
+		--counter;
+	}
+	return erased;
+}
+
+// Insert a batch of values
+template <typename T, typename Compare>
+size_t BasicPersistentSet<T, Compare>::insert_batch(std::vector<T> values) {
+	sort_unique(values);
+
+	root = unite(root, build(values, 0, values.size()));
+
+	size_t n = size(root) - counter;
+	counter = size(root);
+	return n;
+}
+
+// Remove a batch of values
+template <typename T, typename Compare>
+size_t BasicPersistentSet<T, Compare>::erase_batch(std::vector<T> values) {
+	sort_unique(values);
+
+	root = subtract(root, build(values, 0, values.size()));
+
+	size_t n = counter - size(root);
+	counter = size(root);
+	return n;
+}
+
+// Values in increasing order
+template <typename T, typename Compare>
+std::vector<T> BasicPersistentSet<T, Compare>::to_vector() const {
+	std::vector<T> v;
+	v.reserve(counter);
+
+	to_vector(root, v);
+	return v;
+}
+
+// Convert to a Set
+template <typename T, typename Compare>
+BasicSet<T, Compare> BasicPersistentSet<T, Compare>::to_set() const {
+	BasicSet<T, Compare> S{comp};
+
+	S.insert_batch(to_vector());
+	return S;
+}
+
+// Subset test
+// A few values are looked up in b, otherwise both trees are walked in order side by side
+template <typename T, typename Compare>
+bool BasicPersistentSet<T, Compare>::operator<=(const BasicPersistentSet& b) const {
+	if (counter > b.counter) return false;
+	if (root == b.root) return true;
+
+	if (counter * height(b.root) < counter + b.counter) {
+		return all_members(root.get(), b);
+	}
+
+	Cursor a{root.get()};
+	Cursor c{b.root.get()};
+
+	while (!a.done() && !c.done()) {
+		if (comp(a.value(), c.value())) return false;  // a value of *this missing in b
+
+		if (!comp(c.value(), a.value())) a.next();
+		c.next();
+	}
+
+	return a.done();
+}
+
+// Equality test
+template <typename T, typename Compare>
+bool BasicPersistentSet<T, Compare>::operator==(const BasicPersistentSet& b) const {
+	return counter == b.counter && *this <= b;
+}
+
+// Inequality test
+template <typename T, typename Compare>
+bool BasicPersistentSet<T, Compare>::operator!=(const BasicPersistentSet& b) const {
+	return !(*this == b);
+}
+
+// Strict subset test
+template <typename T, typename Compare>
+bool BasicPersistentSet<T, Compare>::operator<(const BasicPersistentSet& b) const {
+	return counter < b.counter && *this <= b;
+}
+
+// Union, e.g. all nodes of S are shared if *this is empty
+template <typename T, typename Compare>
+BasicPersistentSet<T, Compare>& BasicPersistentSet<T, Compare>::operator+=(const BasicPersistentSet& S) {
+	root = unite(root, S.root);
+	counter = size(root);
+	return *this;
+}
+
+// Intersection
+template <typename T, typename Compare>
+BasicPersistentSet<T, Compare>& BasicPersistentSet<T, Compare>::operator*=(const BasicPersistentSet& S) {
+	root = intersect(root, S.root);
+	counter = size(root);
+	return *this;
+}
+
+// Difference
+template <typename T, typename Compare>
+BasicPersistentSet<T, Compare>& BasicPersistentSet<T, Compare>::operator-=(const BasicPersistentSet& S) {
+	root = subtract(root, S.root);
+	counter = size(root);
+	return *this;
+}
+
+// Ordering of the values
+template <typename T, typename Compare>
+Compare BasicPersistentSet<T, Compare>::key_comp() const {
+	return comp;
+}
+
+// Number of existing nodes
+template <typename T, typename Compare>
+int BasicPersistentSet<T, Compare>::get_count_nodes() {
+	return count_nodes.load();
+}
+
+/* ******************************************** *
+ * Private member functions                      *
+ * ******************************************** */
+
+// Equivalence of two values, according to comp
+template <typename T, typename Compare>
+bool BasicPersistentSet<T, Compare>::equal(const T& a, const T& b) const {
+	return !comp(a, b) && !comp(b, a);
+}
+
+// Height of subtree t, 0 if it is empty
+template <typename T, typename Compare>
+int BasicPersistentSet<T, Compare>::height(const NodePtr& t) {
+	return (t == nullptr) ? 0 : t->height;
+}
+
+// Number of values in subtree t
+template <typename T, typename Compare>
+size_t BasicPersistentSet<T, Compare>::size(const NodePtr& t) {
+	return (t == nullptr) ? 0 : t->size;
+}
+
+// New node with subtrees left and right, which are shared
+template <typename T, typename Compare>
+auto BasicPersistentSet<T, Compare>::make_node(const NodePtr& left, const T& val, const NodePtr& right) -> NodePtr {
+	return std::make_shared<const Node>(left, val, right);
+}
+
+// New node with subtrees left and right, whose heights differ by at most 2, rotated to restore the AVL property
+template <typename T, typename Compare>
+auto BasicPersistentSet<T, Compare>::balance(const NodePtr& left, const T& val, const NodePtr& right) -> NodePtr {
+	int hl = height(left);
+	int hr = height(right);
+
+	if (hl > hr + 1) {
+		if (height(left->left) >= height(left->right)) {  // single right rotation
+			return make_node(left->left, left->value, make_node(left->right, val, right));
+		}
+		// double rotation, left->right becomes the root
+		const NodePtr& lr = left->right;
+		return make_node(make_node(left->left, left->value, lr->left), lr->value, make_node(lr->right, val, right));
+	}
+
+	if (hr > hl + 1) {
+		if (height(right->right) >= height(right->left)) {  // single left rotation
+			return make_node(make_node(left, val, right->left), right->value, right->right);
+		}
+		// double rotation, right->left becomes the root
+		const NodePtr& rl = right->left;
+		return make_node(make_node(left, val, rl->left), rl->value, make_node(rl->right, right->value, right->right));
+	}
+
+	return make_node(left, val, right);
+}
+
+// Tree with the values of left, val and the values of right, in this order, for subtrees of any heights
+// The spine of the higher subtree is copied down to the height of the other one, O(|height(left) - height(right)| + 1)
+template <typename T, typename Compare>
+auto BasicPersistentSet<T, Compare>::join(const NodePtr& left, const T& val, const NodePtr& right) -> NodePtr {
+	if (height(left) > height(right) + 1) {
+		return balance(left->left, left->value, join(left->right, val, right));
+	}
+
+	if (height(right) > height(left) + 1) {
+		return balance(join(left, val, right->left), right->value, right->right);
+	}
+
+	return make_node(left, val, right);
+}
+
+// Tree with the values of left, then the values of right
+template <typename T, typename Compare>
+auto BasicPersistentSet<T, Compare>::join(const NodePtr& left, const NodePtr& right) -> NodePtr {
+	if (left == nullptr) return right;
+	if (right == nullptr) return left;
+
+	T min = right->value;
+	NodePtr rest = erase_min(right, min);
+	return join(left, min, rest);
+}
+
+// Split subtree t into the values smaller than val (left) and larger than val (right)
+// Return true if val belongs to t, O(height(t))
+template <typename T, typename Compare>
+bool BasicPersistentSet<T, Compare>::split(const NodePtr& t, const T& val, NodePtr& left, NodePtr& right) const {
+	if (t == nullptr) {
+		left = nullptr;
+		right = nullptr;
+		return false;
+	}
+
+	if (comp(val, t->value)) {
+		NodePtr rest;
+		bool found = split(t->left, val, left, rest);
+		right = join(rest, t->value, t->right);
+		return found;
+	}
+
+	if (comp(t->value, val)) {
+		NodePtr rest;
+		bool found = split(t->right, val, rest, right);
+		left = join(t->left, t->value, rest);
+		return found;
+	}
+
+	left = t->left;
+	right = t->right;
+	return true;
+}
+
+// Union of subtrees t1 and t2: t2 is split at the root of t1, and the halves are merged recursively
+// t1 is returned itself when no value of t2 is missing in it
+template <typename T, typename Compare>
+auto BasicPersistentSet<T, Compare>::unite(const NodePtr& t1, const NodePtr& t2) const -> NodePtr {
+	if (t1 == nullptr) return t2;
+	if (t2 == nullptr || t1 == t2) return t1;
+
+	NodePtr left2;
+	NodePtr right2;
+	split(t2, t1->value, left2, right2);
+
+	NodePtr left = unite(t1->left, left2);
+	NodePtr right = unite(t1->right, right2);
+
+	if (left == t1->left && right == t1->right) return t1;
+	return join(left, t1->value, right);
+}
+
+// Intersection of subtrees t1 and t2, t1 is returned itself when all its values belong to t2
+template <typename T, typename Compare>
+auto BasicPersistentSet<T, Compare>::intersect(const NodePtr& t1, const NodePtr& t2) const -> NodePtr {
+	if (t1 == nullptr || t2 == nullptr) return nullptr;
+	if (t1 == t2) return t1;
+
+	NodePtr left2;
+	NodePtr right2;
+	bool found = split(t2, t1->value, left2, right2);
+
+	NodePtr left = intersect(t1->left, left2);
+	NodePtr right = intersect(t1->right, right2);
+
+	if (!found) return join(left, right);
+	if (left == t1->left && right == t1->right) return t1;
+	return join(left, t1->value, right);
+}
+
+// Difference of subtrees t1 and t2, t1 is returned itself when none of its values belongs to t2
+template <typename T, typename Compare>
+auto BasicPersistentSet<T, Compare>::subtract(const NodePtr& t1, const NodePtr& t2) const -> NodePtr {
+	if (t1 == nullptr || t1 == t2) return nullptr;
+	if (t2 == nullptr) return t1;
+
+	NodePtr left2;
+	NodePtr right2;
+	bool found = split(t2, t1->value, left2, right2);
+
+	NodePtr left = subtract(t1->left, left2);
+	NodePtr right = subtract(t1->right, right2);
+
+	if (found) return join(left, right);
+	if (left == t1->left && right == t1->right) return t1;
+	return join(left, t1->value, right);
+}
+
+// Test whether every value of subtree t belongs to b, with one lookup per value
+template <typename T, typename Compare>
+bool BasicPersistentSet<T, Compare>::all_members(const Node* t, const BasicPersistentSet& b) const {
+	if (t == nullptr) return true;
+
+	return b.is_member(t->value) && all_members(t->left.get(), b) && all_members(t->right.get(), b);
+}
+
+// Perfectly balanced tree with the values v[first], ..., v[last - 1]
+template <typename T, typename Compare>
+auto BasicPersistentSet<T, Compare>::build(const std::vector<T>& v, size_t first, size_t last) -> NodePtr {
+	if (first == last) return nullptr;
+
+	size_t mid = first + (last - first) / 2;
+	return make_node(build(v, first, mid), v[mid], build(v, mid + 1, last));
+}
+
+// Subtree t with val inserted, or t itself if val belongs to it
+template <typename T, typename Compare>
+auto BasicPersistentSet<T, Compare>::insert(const NodePtr& t, const T& val, bool& inserted) const -> NodePtr {
+	if (t == nullptr) {
+		inserted = true;
+		return make_node(nullptr, val, nullptr);
+	}
+
+	if (comp(val, t->value)) {
+		NodePtr left = insert(t->left, val, inserted);
+		return inserted ? balance(left, t->value, t->right) : t;
+	}
+
+	if (comp(t->value, val)) {
+		NodePtr right = insert(t->right, val, inserted);
+		return inserted ? balance(t->left, t->value, right) : t;
+	}
+
+	return t;  // val already belongs to the PersistentSet
+}
+
+// Subtree t without val, or t itself if val does not belong to it
+template <typename T, typename Compare>
+auto BasicPersistentSet<T, Compare>::erase(const NodePtr& t, const T& val, bool& erased) const -> NodePtr {
+	if (t == nullptr) return nullptr;
+
+	if (comp(val, t->value)) {
+		NodePtr left = erase(t->left, val, erased);
+		return erased ? balance(left, t->value, t->right) : t;
+	}
+
+	if (comp(t->value, val)) {
+		NodePtr right = erase(t->right, val, erased);
+		return erased ? balance(t->left, t->value, right) : t;
+	}
+
+	erased = true;
+
+	if (t->left == nullptr) return t->right;
+	if (t->right == nullptr) return t->left;
+
+	// replace the value by its successor, the smallest value of the right subtree
+	T min = t->value;
+	NodePtr right = erase_min(t->right, min);
+	return balance(t->left, min, right);
+}
+
+// Subtree t without its smallest value, which is stored in min
+template <typename T, typename Compare>
+auto BasicPersistentSet<T, Compare>::erase_min(const NodePtr& t, T& min) -> NodePtr {
+	if (t->left == nullptr) {
+		min = t->value;
+		return t->right;
+	}
+
+	return balance(erase_min(t->left, min), t->value, t->right);
+}
+
+// Append the values of subtree t to v, in increasing order
+template <typename T, typename Compare>
+void BasicPersistentSet<T, Compare>::to_vector(const NodePtr& t, std::vector<T>& v) {
+	if (t == nullptr) return;
+
+	to_vector(t->left, v);
+	v.push_back(t->value);
+	to_vector(t->right, v);
+}
+
+// Sort v by comp and remove repetitions
+template <typename T, typename Compare>
+void BasicPersistentSet<T, Compare>::sort_unique(std::vector<T>& v) const {
+	std::sort(v.begin(), v.end(), comp);
+	v.erase(std::unique(v.begin(), v.end(), [this](const T& a, const T& b) { return equal(a, b); }), v.end());
+}
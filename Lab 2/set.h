@@ -1,36 +1,83 @@
 #include <iostream>
 #include <vector>
 #include <utility>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+
+#include "alloc_stats.h"
 
 #pragma once
 
-/** Class to represent a Set of ints
+template <typename E>
+class SetExpr;
+
+template <typename S>
+class SetLeaf;
+
+class SetSketch;
+class BlockedBloomFilter;
+
+/** Traits of the values stored in a BasicSet
+ *
+ * Integral values ordered by std::less or std::greater are equal exactly when their bits are equal,
+ * so they can be hashed: the sketches (sketch.h) and the Bloom filter (bloom.h) are only
+ * available for such values. Other types use the comparison-based code paths only
+ *
+ */
+template <typename T, typename Compare>
+struct set_value_traits {
+	static constexpr bool hashable =
+		std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+		(std::is_same<Compare, std::less<T>>::value || std::is_same<Compare, std::greater<T>>::value);
+};
+
+/** Class to represent a Set of values of type T
  *
- * Set is implemented as a sorted doubly linked list
+ * BasicSet is implemented as a sorted doubly linked list
  * Sets should not contain repetitions, i.e.
- * two ints with the same value cannot belong to a Set
+ * two values a and b such that !comp(a, b) && !comp(b, a) cannot belong to the same Set
+ *
+ * \param T type of the values
+ * \param Compare strict weak ordering of the values, the list is sorted by it
+ * \param Allocator allocator of the values, rebound to allocate the nodes
  *
  * All Set operations must have a linear complexity, in the worst case
  */
-class Set {
+template <typename T, typename Compare = std::less<T>, typename Allocator = std::allocator<T>>
+class BasicSet {
 
 public:
+	using value_type = T;
+	using key_compare = Compare;
+	using allocator_type = Allocator;
+	using size_type = size_t;
+
 	// Default constructor: create an empty Set
 	// IMPLEMENT before HA session on week 16
-	Set();
+	BasicSet();
+
+	// Create an empty Set ordered by comp, allocating its nodes with alloc
+	explicit BasicSet(const Compare& comp, const Allocator& alloc = Allocator());
+
+	// Create an empty Set allocating its nodes with alloc
+	explicit BasicSet(const Allocator& alloc);
 
 	// Conversion constructor: Convert val into a singleton {val}
 	// IMPLEMENT before HA session on week 16
-	Set(int val);
+	BasicSet(const T& val);
 
-	/** Constructor to create a Set from a sorted vector of ints
+	/** Constructor to create a Set from a sorted vector
 	 *
-	 * Create a Set with all ints in sorted vector v
-	 * \param v sorted vector of ints
+	 * Create a Set with all values in sorted vector v
+	 * \param v vector sorted by Compare, without repetitions (checked by an assert)
+	 * Use from_unsorted for any other vector
 	 *
 	 */
 	// IMPLEMENT before HA session on week 16
-	Set(const std::vector<int>& v);
+	BasicSet(const std::vector<T>& v);
 
 	/** Copy constructor
 	 *
@@ -40,7 +87,36 @@ public:
 	 *
 	 */
 	// IMPLEMENT before HA session on week 16
-	Set(const Set& b);
+	BasicSet(const BasicSet& b);
+
+	/** Move constructor
+	 *
+	 * Take over the nodes, the sketches and the Bloom filter of Set b in O(1)
+	 * b becomes an empty Set
+	 *
+	 */
+	BasicSet(BasicSet&& b);
+
+	/** Constructor to create a Set from an expression
+	 *
+	 * Evaluate a compound expression such as (A + B) * C - D in one fused merge
+	 * Only the nodes of the resulting Set are allocated, see set_expr.h
+	 * \param expr expression returned by operator+, operator*, operator- or operator^
+	 *
+	 */
+	template <typename E>
+	BasicSet(const SetExpr<E>& expr);
+
+	/** Create a Set with all values in vector values
+	 *
+	 * \param values unsorted values, possibly with repetitions
+	 * The values are sorted and repetitions are removed, then the nodes are built in one pass
+	 * Integral values ordered by std::less or std::greater are sorted by a (parallel for large vectors)
+	 * radix sort, with one pass per byte and no comparisons; other values by a (parallel) std::sort
+	 *
+	 */
+	static BasicSet from_unsorted(std::vector<T> values, const Compare& comp = Compare(),
+								  const Allocator& alloc = Allocator());
 
 	/** Destructor
 	 *
@@ -48,7 +124,7 @@ public:
 	 *
 	 */
 	// IMPLEMENT before HA session on week 16
-	~Set();
+	~BasicSet();
 
 	/** Assignment operator
 	 *
@@ -58,7 +134,7 @@ public:
 	 *
 	 */
 	// IMPLEMENT before HA session on week 16
-	Set& operator=(Set source);
+	BasicSet& operator=(BasicSet source);
 
 	/** Test whether the Set is empty
 	 *
@@ -83,7 +159,7 @@ public:
 	 *
 	 */
 	// IMPLEMENT before HA session on week 16
-	bool is_member(int val) const;
+	bool is_member(const T& val) const;
 
 	/** Transform the Set into an empty se
 	 *
@@ -93,6 +169,60 @@ public:
 	// IMPLEMENT before HA session on week 16
 	void make_empty();
 
+	/** Insert val into the Set
+	 *
+	 * The list is walked up to the position of val, i.e. linear complexity
+	 * Return true if val was inserted, false if it already belonged to the Set
+	 *
+	 */
+	bool insert(const T& val);
+
+	/** Remove val from the Set
+	 *
+	 * Return true if val was removed, false if it did not belong to the Set
+	 *
+	 */
+	bool erase(const T& val);
+
+	/** Insert all values in a batch
+	 *
+	 * \param values unsorted values, possibly with repetitions
+	 * The batch is sorted and repetitions are removed (in parallel for large batches),
+	 * then it is applied to the Set with one linear merge
+	 * Return number of values inserted
+	 *
+	 */
+	size_t insert_batch(std::vector<T> values);
+
+	/** Remove all values in a batch
+	 *
+	 * \param values unsorted values, possibly with repetitions
+	 * The batch is sorted and repetitions are removed (in parallel for large batches),
+	 * then it is applied to the Set with one linear merge
+	 * Return number of values removed
+	 *
+	 */
+	size_t erase_batch(std::vector<T> values);
+
+	/** Move the values not smaller than val into a new Set
+	 *
+	 * *this keeps the values smaller than val, e.g. {1 3 5 7}.split_at(5) returns {5 7} and leaves {1 3}
+	 * The nodes are relinked, not copied. The new Set has the ordering and the allocator of *this
+	 * Return the Set of the values not smaller than val
+	 *
+	 */
+	BasicSet split_at(const T& val);
+
+	/** Move the values satisfying a predicate into a new Set
+	 *
+	 * \param pred unary predicate on the values
+	 * The list is walked once and the nodes of the values v such that pred(v) are relinked, not copied
+	 * Return the Set of the values v such that pred(v)
+	 *
+	 */
+	template <typename Pred>
+	BasicSet extract_if(Pred pred);
+
 	/** Test whether Set *this is a subset of Set b
 	 *
 	 * a <= b iff every member of a is a member of b
@@ -101,7 +231,7 @@ public:
 	 *
 	 */
 	// IMPLEMENT
-	bool operator<=(const Set& b) const;
+	bool operator<=(const BasicSet& b) const;
 
 	/** Test whether Set *this and b represent the same set
 	 *
@@ -111,7 +241,7 @@ public:
 	 *
 	 */
 	// IMPLEMENT
-	bool operator==(const Set& b) const;
+	bool operator==(const BasicSet& b) const;
 
 	/** Test whether Set *this and b represent different sets
 	 *
@@ -121,7 +251,7 @@ public:
 	 *
 	 */
 	// IMPLEMENT
-	bool operator!=(const Set& b) const;
+	bool operator!=(const BasicSet& b) const;
 
 	/** Test whether Set *this is a strict subset of Set b
 	 *
@@ -130,12 +260,49 @@ public:
 	 * Return true, if *this is a strict subset of b, otherwise false
 	 */
 	// IMPLEMENT
-	bool operator<(const Set& b) const;
+	bool operator<(const BasicSet& b) const;
 
-	/** Return number of existing nodes
+	/* ******************************************** *
+	 * Relation queries                             *
+	 * One merge of both lists, no nodes allocated  *
+	 * ******************************************** */
+
+	// How two Sets relate to each other, see relation()
+	enum class Relation { Equal, Subset, Superset, Disjoint, Overlapping };
+
+	/** Classify how Set *this relates to Set b
+	 *
+	 * Equal: same values, Subset/Superset: strict subset/superset of b,
+	 * Disjoint: no common values, Overlapping: none of the above
+	 * An empty Set is a Subset of any non-empty Set
+	 * The merge stops as soon as the Sets are known to be Overlapping
+	 *
+	 */
+	Relation relation(const BasicSet& b) const;
+
+	/** Return the number of values in both *this and b, i.e. |a*b|
+	 *
+	 */
+	size_t intersection_size(const BasicSet& b) const;
+
+	/** Return the number of values in *this or b, i.e. |a+b|
+	 *
+	 */
+	size_t union_size(const BasicSet& b) const;
+
+	/** Return the Jaccard similarity |a*b| / |a+b|
+	 *
+	 * Two empty Sets have similarity 1
+	 *
+	 */
+	double jaccard(const BasicSet& b) const;
+
+	/** Test whether *this and b have no common values
+	 *
+	 * The merge stops at the first common value
 	 *
-	 * Used for debug purposes
 	 */
+	bool is_disjoint(const BasicSet& b) const;
 
 	/** Modify Set *this such that it becomes the union of *this with Set S
 	 *
@@ -143,7 +310,7 @@ public:
 	 *
 	 */
 	// IMPLEMENT
-	Set& operator+=(const Set& S);
+	BasicSet& operator+=(const BasicSet& S);
 
 	/** Modify Set *this such that it becomes the intersection of *this with Set S
 	 *
@@ -151,7 +318,7 @@ public:
 	 *
 	 */
 	// IMPLEMENT
-	Set& operator*=(const Set& S);
+	BasicSet& operator*=(const BasicSet& S);
 
 	/** Modify Set *this such that it becomes the Set difference between Set *this and Set S
 	 *
@@ -159,22 +326,213 @@ public:
 	 *
 	 */
 	// IMPLEMENT
-	Set& operator-=(const Set& S);
+	BasicSet& operator-=(const BasicSet& S);
+
+	/** Modify Set *this such that it becomes the symmetric difference of Set *this and Set S
+	 *
+	 * The values that belong to exactly one of the Sets, i.e. (*this - S) + (S - *this), in one merge
+	 * Set *this is modified and then returned
+	 *
+	 */
+	BasicSet& operator^=(const BasicSet& S);
 
 	/** Return number of existing nodes in the current program
 	 *
-	 * Used for debug purposes
+	 * Nodes are counted per instantiation, e.g. BasicSet<int> and BasicSet<std::string> have separate counters
+	 * Used for debug purposes, same as global_alloc_stats().live_blocks
 	 *
 	 */
 	static int get_count_nodes();
 
+	/** Return the memory statistics of all Sets of this type, see alloc_stats.h
+	 *
+	 * Live and peak bytes of the nodes, number of nodes allocated and freed by each operation,
+	 * and number of nodes visited by is_member
+	 * Only the live nodes are counted while set_global_alloc_stats(true) has not been called
+	 *
+	 */
+	static AllocStats global_alloc_stats();
+
+	/** Turn the memory statistics of all Sets of this type on or off
+	 *
+	 * Off by default: every Set of the type would update the same counters on every node
+	 * allocated and freed, and on every is_member, even concurrent readers
+	 * The number of live nodes of get_count_nodes is always counted
+	 * Meant to be called while no other thread uses Sets of this type
+	 *
+	 */
+	static void set_global_alloc_stats(bool on);
+
+	/** Turn the memory statistics of this Set on or off
+	 *
+	 * When on, the Set counts the nodes allocated and freed by each of its operations
+	 * and the nodes visited by is_member, whether the global statistics are on or not
+	 * Copies of the Set do not inherit the statistics
+	 * Off by default
+	 *
+	 */
+	void set_alloc_stats(bool on);
+
+	/** Return the memory statistics of this Set
+	 *
+	 * set_alloc_stats(true) must be called first
+	 * Nodes shared by copy-on-write are counted in the live bytes of every Set sharing them
+	 *
+	 */
+	AllocStats alloc_stats() const;
+
+	/** Return the ordering of the values
+	 *
+	 */
+	Compare key_comp() const;
+
+	/** Return the allocator of the values
+	 *
+	 */
+	Allocator get_allocator() const;
+
+	/* ******************************************** *
+	 * Iterators, see iterator.h                    *
+	 * ******************************************** */
+
+	class Iterator;  // bi-directional iterator, values cannot be modified
+	class Range;     // view of a range of values
+
+	using iterator = Iterator;
+	using const_iterator = Iterator;
+
+	/** Return an iterator to the smallest value in the Set
+	 *
+	 */
+	Iterator begin() const;
+
+	/** Return an iterator to the position after the largest value in the Set
+	 *
+	 * Decrementing end() gives the largest value, if the Set is not empty
+	 */
+	Iterator end() const;
+
+	/** Return an iterator to the first value not smaller than val, or end()
+	 *
+	 * The list is walked from the smallest value, i.e. linear complexity
+	 */
+	Iterator lower_bound(const T& val) const;
+
+	/** Return an iterator to the first value larger than val, or end()
+	 *
+	 */
+	Iterator upper_bound(const T& val) const;
+
+	/** Return a view of all values v such that lo <= v <= hi
+	 *
+	 * No values are copied, e.g. for (int v : S.values_between(1, 10))
+	 */
+	Range values_between(const T& lo, const T& hi) const;
+
+	/** Set the size from which batches of values are sorted in parallel
+	 *
+	 * When from_unsorted, insert_batch or erase_batch sort at least n values,
+	 * the vector is split into chunks sorted by one thread each
+	 * The Set operations always merge the lists sequentially
+	 *
+	 */
+	static void set_parallel_threshold(size_t n);
+
+	/** Turn copy-on-write on or off
+	 *
+	 * When on, copies of the Set (copy constructor, operator=, call by value)
+	 * share its nodes, its sketches and its Bloom filter in O(1) instead of cloning them.
+	 * A Set gets its own copy of all of them the first time it is modified
+	 * (+=, *=, -=, make_empty, insert, erase, ...)
+	 * Copies of a copy-on-write Set are copy-on-write too
+	 * Off by default
+	 *
+	 */
+	void set_copy_on_write(bool on);
+
+	/** Return true, if copy-on-write is on
+	 *
+	 */
+	bool is_copy_on_write() const;
+
+	/** Return true, if the nodes are currently shared with other copies
+	 *
+	 */
+	bool is_shared() const;
+
+	/** Turn the sketches of the Set on or off
+	 *
+	 * When on, the Set maintains a MinHash signature and HyperLogLog registers (see sketch.h)
+	 * for fast approximate Jaccard similarity, union cardinality and LSH bucketing
+	 * The sketches are updated by insert, insert_batch and +=,
+	 * and rebuilt on demand after the other operations
+	 * Only available if set_value_traits<T, Compare>::hashable
+	 * Off by default
+	 *
+	 */
+	void set_sketching(bool on);
+
+	/** Return the sketches of the Set
+	 *
+	 * set_sketching(true) must be called first
+	 * Like the other const member functions, it can be called by several threads at the same time
+	 *
+	 */
+	const SetSketch& sketch() const;
+
+	/** Turn the Bloom filter of the Set on or off
+	 *
+	 * \param fp_rate false-positive budget of the filter, e.g. 0.01; 0 turns the filter off
+	 * When on, is_member rejects most absent values after one cache miss in a
+	 * cache-line blocked Bloom filter (see bloom.h), without walking the list
+	 * The filter is updated by insert, insert_batch and +=, and rebuilt after *=, -= and erase_batch
+	 * Only available if set_value_traits<T, Compare>::hashable
+	 * Off by default
+	 *
+	 */
+	void set_bloom_filter(double fp_rate);
+
+	/** Return the Bloom filter, with its hit/miss counters, or nullptr if it is off
+	 *
+	 * Copy-on-write copies share the filter and its counters until one of them is modified
+	 *
+	 */
+	const BlockedBloomFilter* bloom_filter() const;
+
 private:
 	class Node;  // nested class defined in file node.h
 
+	using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+	using NodeTraits = std::allocator_traits<NodeAllocator>;
+
+	static constexpr bool hashable = set_value_traits<T, Compare>::hashable;
+
 	Node* head;      // Pointer to the dummy header Node
 	Node* tail;      // Pointer to the dummy tail Node
 	size_t counter;  // number of values in the Set
 
+	Compare comp;         // ordering of the values
+	NodeAllocator alloc;  // allocator of the nodes
+
+	// Number of Sets sharing the nodes, nullptr if copy-on-write is off
+	std::atomic<size_t>* refs;
+
+	// Sketches of the values, nullptr if sketching is off
+	// The sketches and the Bloom filter are shared by the Sets sharing the nodes
+	mutable std::shared_ptr<SetSketch> sketch_ptr;
+	mutable bool sketch_valid;  // false if the sketches must be rebuilt
+	mutable std::mutex sketch_mutex;  // guards sketch_ptr and sketch_valid in the const member functions
+
+	// Bloom filter of the values, nullptr if it is off
+	std::shared_ptr<BlockedBloomFilter> bloom;
+
+	static AllocCounter global_stats;  // memory statistics of all Sets of this type
+	AllocCounter* local_stats;         // memory statistics of this Set, nullptr if they are off
+	AllocStats::Op current_op;         // operation the allocations are charged to
+
+	// RAII guard charging the allocations to an operation, see alloc_stats.h
+	class OpGuard;
+
 	/* ***************************** *
 	 * Overloaded Global Operators   *
 	 * ***************************** */
@@ -184,40 +542,96 @@ private:
 	 * \param os ostream object where the set b elements are written
 	 *
 	 */
-	friend std::ostream& operator<<(std::ostream& os, const Set& b);
+	friend std::ostream& operator<<(std::ostream& os, const BasicSet& b) {
+		if (b.is_empty()) {
+			os << "Set is empty!";
+		} else {
+			os << "{ ";
+			for (const T& val : b) {
+				os << val << " ";
+			}
 
-	/** Overloaded operator+: Set union S1+S2
-	 *
-	 * S1+S2 is the Set of elements in Set S1 or in Set S2 (without repeated elements)
-	 * Function does not modify S2 in any way
-	 * Return a new Set representing the union of S1 with S2, S1+S2
-	 *
-	 */
-	friend Set operator+(Set S1, const Set& S2) {
-		return (S1 += S2);
-	}
+			os << "}";
+		}
 
-	/** Overloaded operator*: Set intersection S1*S2
-	 *
-	 * S1*S2 is the Set of elements in both Sets S1 and set S2
-	 * Return a new Set representing the intersection of S1 with S2, S1*S2
-	 *
-	 */
-	friend Set operator*(Set S1, const Set& S2) {
-		return (S1 *= S2);
+		return os;
 	}
 
-	/** Overloaded operator-: Set difference S1-S2
-	 *
-	 * S1-S2 is the Set of elements in Set S1 that do not belong to Set S2
-	 * Return a new Set representing the set difference S1-S2
-	 *
-	 */
-	friend Set operator-(Set S1, const Set& S2) {
-		return (S1 -= S2);
-	}
+	// Expression leaf walking the nodes of a Set, see set_expr.h
+	template <typename S>
+	friend class SetLeaf;
+
+	Node* create_node(const T& val, Node* next, Node* prev);
+
+	void destroy_node(Node* ptr);
+
+	void init_dummy_nodes();
+
+	// Tag of the constructor used by from_unsorted
+	struct Unsorted {};
+
+	BasicSet(Unsorted, std::vector<T>& values, const Compare& comp, const Allocator& alloc);
+
+	void append_sorted(const std::vector<T>& v);
+
+	bool equal(const T& a, const T& b) const;
+
+	bool find_value(const T& val, size_t& steps) const;
 
-	void insert(Node *ptr, int val);
+	void insert(Node *ptr, const T& val);
 
 	void remove(Node* ptr);
-};
\ No newline at end of file
+
+	void move_node(Node* ptr, BasicSet& S);
+
+	void prepare_mutation();
+
+	void clone_nodes(const Node* first, const Node* last);
+
+	void clone_summaries();
+
+	void sketch_add(const T& val);
+
+	void bloom_add(const T& val);
+
+	void rebuild_bloom_filter();
+
+	/* ********************************************* *
+	 * Range merges used by operator+=, *= and -=    *
+	 * ********************************************* */
+
+	void merge_union(const Node* first, const Node* last);
+
+	void merge_intersection(const Node* first, const Node* last);
+
+	void merge_difference(const Node* first, const Node* last);
+
+	void merge_symmetric_difference(const Node* first, const Node* last);
+
+	bool is_subset(const Node* first, const Node* last, const Node* s_first, const Node* s_last) const;
+
+	static size_t parallel_threshold;  // minimum number of values sorted in parallel
+
+	static size_t number_of_parts();
+
+	void sort_unique(std::vector<T>& v) const;
+
+	static constexpr size_t radix_threshold = 1024;  // minimum number of values sorted by radix_sort
+
+	void radix_sort(std::vector<T>& v) const;
+};
+
+// Set of ints, the original interface of this lab
+using Set = BasicSet<int>;
+
+//Include the definition of class BasicSet::Node
+#include "node.h"
+
+//Include the definition of class BasicSet::Iterator
+#include "iterator.h"
+
+//Include the definitions of the member functions
+#include "set_impl.h"
+
+//Include the overloaded operators +, *, - and ^ building expressions
+#include "set_expr.h"
@@ -0,0 +1,580 @@
+#include <iostream>
+#include <type_traits>
+
+#include "set.h"
+#include "node.h"
+
+#pragma once
+
+/** Expression templates for compound Set algebra
+ *
+ * The operators +, *, - and ^ no longer build a Set for every intermediate result.
+ * Instead they return a lightweight expression object describing the computation,
+ * e.g. (A + B) * C - D becomes SetDifference<SetIntersection<SetUnion<...>, ...>, ...>
+ *
+ * Every expression is a cursor over a sorted stream of values:
+ *   done()  -- true if the stream is exhausted
+ *   value() -- current (smallest remaining) value, only valid if !done()
+ *   next()  -- move to the next value
+ *   key_comp() -- ordering of the stream, the Compare of the Sets
+ *
+ * The expression is evaluated in a single fused merge when it is assigned to a Set,
+ * converted into a Set, compared with ==, !=, <= or <, written to an ostream,
+ * or queried with is_empty() or cardinality(), like a Set.
+ * Only the final result allocates Nodes and every input list is walked once.
+ *
+ * Expressions store pointers to the Sets they refer to. They are meant to be used
+ * within the full expression where they are created, e.g. Set S = (A + B) * C;
+ * Do not keep them around with auto, nor modify the operands before evaluation.
+ */
+template <typename E>
+class SetExpr {
+public:
+	const E& self() const {
+		return static_cast<const E&>(*this);
+	}
+
+	/** Test whether the resulting Set is empty, no Set is materialized
+	 *
+	 */
+	bool is_empty() const {
+		E e{self()};
+		return e.done();
+	}
+
+	/** Count the values of the resulting Set, no Set is materialized
+	 *
+	 */
+	size_t cardinality() const {
+		size_t n = 0;
+		for (E e{self()}; !e.done(); e.next()) {
+			++n;
+		}
+		return n;
+	}
+};
+
+/** Leaf of an expression: walks the nodes of an existing Set of type S
+ *
+ */
+template <typename S>
+class SetLeaf : public SetExpr<SetLeaf<S>> {
+public:
+	using value_type = typename S::value_type;
+	using key_compare = typename S::key_compare;
+
+	explicit SetLeaf(const S& set)
+		: ptr{set.head->next}, tail{set.tail}, comp{set.comp} {
+	}
+
+	bool done() const {
+		return ptr == tail;
+	}
+
+	const value_type& value() const {
+		return ptr->value;
+	}
+
+	void next() {
+		ptr = ptr->next;
+	}
+
+	const key_compare& key_comp() const {
+		return comp;
+	}
+
+private:
+	const typename S::Node* ptr;
+	const typename S::Node* tail;
+	key_compare comp;
+};
+
+/** Leaf of an expression: the singleton {val}
+ *
+ * Used by mixed-mode arithmetic such as S - 5, without allocating a Set{5}
+ * comp is the ordering of the other operand, which may hold state
+ */
+template <typename T, typename Compare>
+class SetSingleton : public SetExpr<SetSingleton<T, Compare>> {
+public:
+	using value_type = T;
+	using key_compare = Compare;
+
+	SetSingleton(const T& val, const key_compare& comp)
+		: val{val}, finished{false}, comp{comp} {
+	}
+
+	bool done() const {
+		return finished;
+	}
+
+	const T& value() const {
+		return val;
+	}
+
+	void next() {
+		finished = true;
+	}
+
+	const key_compare& key_comp() const {
+		return comp;
+	}
+
+private:
+	T val;
+	bool finished;
+	key_compare comp;
+};
+
+// Both operands of a binary expression must hold the same values in the same order:
+// merging streams of different types would compare converted temporaries, or mix two orderings
+template <typename L, typename R>
+struct same_set_types : std::integral_constant<bool,
+	std::is_same<typename L::value_type, typename R::value_type>::value &&
+	std::is_same<typename L::key_compare, typename R::key_compare>::value> {};
+
+/** Expression L+R: union of two sorted streams
+ *
+ */
+template <typename L, typename R>
+class SetUnion : public SetExpr<SetUnion<L, R>> {
+public:
+	using value_type = typename L::value_type;
+	using key_compare = typename L::key_compare;
+	static_assert(same_set_types<L, R>::value, "operands must have the same value_type and key_compare");
+
+	SetUnion(const L& lhs, const R& rhs)
+		: lhs{lhs}, rhs{rhs}, comp{lhs.key_comp()} {
+	}
+
+	bool done() const {
+		return lhs.done() && rhs.done();
+	}
+
+	const value_type& value() const {
+		if (lhs.done()) return rhs.value();
+		if (rhs.done()) return lhs.value();
+
+		return comp(lhs.value(), rhs.value()) ? lhs.value() : rhs.value();
+	}
+
+	void next() {
+		if (lhs.done()) rhs.next();
+		else if (rhs.done()) lhs.next();
+		else if (comp(lhs.value(), rhs.value())) lhs.next();
+		else if (comp(rhs.value(), lhs.value())) rhs.next();
+		else {
+			lhs.next();
+			rhs.next();
+		}
+	}
+
+	const key_compare& key_comp() const {
+		return comp;
+	}
+
+private:
+	L lhs;
+	R rhs;
+	key_compare comp;
+};
+
+/** Expression L*R: intersection of two sorted streams
+ *
+ * The cursor is always kept on a value present in both streams
+ */
+template <typename L, typename R>
+class SetIntersection : public SetExpr<SetIntersection<L, R>> {
+public:
+	using value_type = typename L::value_type;
+	using key_compare = typename L::key_compare;
+	static_assert(same_set_types<L, R>::value, "operands must have the same value_type and key_compare");
+
+	SetIntersection(const L& lhs, const R& rhs)
+		: lhs{lhs}, rhs{rhs}, comp{lhs.key_comp()} {
+		settle();
+	}
+
+	bool done() const {
+		return lhs.done() || rhs.done();
+	}
+
+	const value_type& value() const {
+		return lhs.value();
+	}
+
+	void next() {
+		lhs.next();
+		rhs.next();
+		settle();
+	}
+
+	const key_compare& key_comp() const {
+		return comp;
+	}
+
+private:
+	L lhs;
+	R rhs;
+	key_compare comp;
+
+	// Advance both streams until they agree on a value or one of them is exhausted
+	void settle() {
+		while (!lhs.done() && !rhs.done()) {
+			if (comp(lhs.value(), rhs.value())) lhs.next();
+			else if (comp(rhs.value(), lhs.value())) rhs.next();
+			else break;
+		}
+	}
+};
+
+/** Expression L-R: difference of two sorted streams
+ *
+ * The cursor is always kept on a value of L that does not belong to R
+ */
+template <typename L, typename R>
+class SetDifference : public SetExpr<SetDifference<L, R>> {
+public:
+	using value_type = typename L::value_type;
+	using key_compare = typename L::key_compare;
+	static_assert(same_set_types<L, R>::value, "operands must have the same value_type and key_compare");
+
+	SetDifference(const L& lhs, const R& rhs)
+		: lhs{lhs}, rhs{rhs}, comp{lhs.key_comp()} {
+		settle();
+	}
+
+	bool done() const {
+		return lhs.done();
+	}
+
+	const value_type& value() const {
+		return lhs.value();
+	}
+
+	void next() {
+		lhs.next();
+		settle();
+	}
+
+	const key_compare& key_comp() const {
+		return comp;
+	}
+
+private:
+	L lhs;
+	R rhs;
+	key_compare comp;
+
+	// Skip the values of lhs that also belong to rhs
+	void settle() {
+		while (!lhs.done() && !rhs.done()) {
+			if (comp(rhs.value(), lhs.value())) rhs.next();
+			else if (comp(lhs.value(), rhs.value())) break;
+			else {
+				lhs.next();
+				rhs.next();
+			}
+		}
+	}
+};
+
+/** Expression L^R: symmetric difference of two sorted streams
+ *
+ * The cursor is always kept on a value that belongs to exactly one of the streams
+ */
+template <typename L, typename R>
+class SetSymmetricDifference : public SetExpr<SetSymmetricDifference<L, R>> {
+public:
+	using value_type = typename L::value_type;
+	using key_compare = typename L::key_compare;
+	static_assert(same_set_types<L, R>::value, "operands must have the same value_type and key_compare");
+
+	SetSymmetricDifference(const L& lhs, const R& rhs)
+		: lhs{lhs}, rhs{rhs}, comp{lhs.key_comp()} {
+		settle();
+	}
+
+	bool done() const {
+		return lhs.done() && rhs.done();
+	}
+
+	const value_type& value() const {
+		if (lhs.done()) return rhs.value();
+		if (rhs.done()) return lhs.value();
+
+		return comp(lhs.value(), rhs.value()) ? lhs.value() : rhs.value();
+	}
+
+	void next() {
+		if (lhs.done()) rhs.next();
+		else if (rhs.done()) lhs.next();
+		else if (comp(lhs.value(), rhs.value())) lhs.next();
+		else rhs.next();
+
+		settle();
+	}
+
+	const key_compare& key_comp() const {
+		return comp;
+	}
+
+private:
+	L lhs;
+	R rhs;
+	key_compare comp;
+
+	// Skip the values that belong to both streams
+	void settle() {
+		while (!lhs.done() && !rhs.done() && !comp(lhs.value(), rhs.value()) && !comp(rhs.value(), lhs.value())) {
+			lhs.next();
+			rhs.next();
+		}
+	}
+};
+
+/* ******************************************** *
+ * Operands of the overloaded operators         *
+ * ******************************************** */
+
+// An operand is a Set, another expression or a value (converted to a singleton) of the other operand
+template <typename T>
+struct is_set_expr : std::is_base_of<SetExpr<T>, T> {};
+
+template <typename T>
+struct is_basic_set : std::false_type {};
+
+template <typename T, typename Compare, typename Allocator>
+struct is_basic_set<BasicSet<T, Compare, Allocator>> : std::true_type {};
+
+template <typename T>
+struct is_set_like : std::integral_constant<bool, is_basic_set<T>::value || is_set_expr<T>::value> {};
+
+// Expression type of operand X, and conversion of X into it
+// Other is the type of the other operand, which gives the type and the ordering of the values of a singleton
+template <typename X, typename Other, typename = void>
+struct operand_expr {
+	using type = SetSingleton<typename Other::value_type, typename Other::key_compare>;
+
+	static type make(const typename Other::value_type& val, const Other& other) {
+		return type{val, other.key_comp()};
+	}
+};
+
+template <typename X, typename Other>
+struct operand_expr<X, Other, std::enable_if_t<is_basic_set<X>::value>> {
+	using type = SetLeaf<X>;
+
+	template <typename O>
+	static type make(const X& S, const O&) {
+		return type{S};
+	}
+};
+
+template <typename X, typename Other>
+struct operand_expr<X, Other, std::enable_if_t<is_set_expr<X>::value>> {
+	using type = X;
+
+	template <typename O>
+	static const X& make(const X& e, const O&) {
+		return e;
+	}
+};
+
+// A value operand must be convertible to the values of the other operand
+template <typename X, typename Other, typename = void>
+struct is_value_operand : std::false_type {};
+
+template <typename X, typename Other>
+struct is_value_operand<X, Other, std::enable_if_t<is_set_like<Other>::value && !is_set_like<X>::value>>
+	: std::is_convertible<X, typename Other::value_type> {};
+
+// At least one operand must be a Set or an expression, value op value is left alone
+template <typename A, typename B>
+using enable_set_operator = std::enable_if_t<
+	(is_set_like<std::decay_t<A>>::value && is_set_like<std::decay_t<B>>::value) ||
+	is_value_operand<std::decay_t<A>, std::decay_t<B>>::value ||
+	is_value_operand<std::decay_t<B>, std::decay_t<A>>::value>;
+
+template <typename X, typename Other>
+using expr_type = typename operand_expr<std::decay_t<X>, std::decay_t<Other>>::type;
+
+template <typename X, typename Other>
+decltype(auto) as_expr(const X& x, const Other& other) {
+	return operand_expr<std::decay_t<X>, std::decay_t<Other>>::make(x, other);
+}
+
+/* ***************************** *
+ * Overloaded Global Operators   *
+ * ***************************** */
+
+/** Overloaded operator+: Set union S1+S2
+ *
+ * S1+S2 is the Set of elements in S1 or in S2 (without repeated elements)
+ * Return an expression representing the union, nothing is computed yet
+ *
+ */
+template <typename A, typename B, typename = enable_set_operator<A, B>>
+SetUnion<expr_type<A, B>, expr_type<B, A>> operator+(const A& S1, const B& S2) {
+	return {as_expr<A, B>(S1, S2), as_expr<B, A>(S2, S1)};
+}
+
+/** Overloaded operator*: Set intersection S1*S2
+ *
+ * S1*S2 is the Set of elements in both S1 and S2
+ * Return an expression representing the intersection, nothing is computed yet
+ *
+ */
+template <typename A, typename B, typename = enable_set_operator<A, B>>
+SetIntersection<expr_type<A, B>, expr_type<B, A>> operator*(const A& S1, const B& S2) {
+	return {as_expr<A, B>(S1, S2), as_expr<B, A>(S2, S1)};
+}
+
+/** Overloaded operator-: Set difference S1-S2
+ *
+ * S1-S2 is the Set of elements in S1 that do not belong to S2
+ * Return an expression representing the difference, nothing is computed yet
+ *
+ */
+template <typename A, typename B, typename = enable_set_operator<A, B>>
+SetDifference<expr_type<A, B>, expr_type<B, A>> operator-(const A& S1, const B& S2) {
+	return {as_expr<A, B>(S1, S2), as_expr<B, A>(S2, S1)};
+}
+
+/** Overloaded operator^: Set symmetric difference S1^S2
+ *
+ * S1^S2 is the Set of elements in exactly one of S1 and S2, i.e. (S1-S2)+(S2-S1)
+ * Return an expression representing the symmetric difference, nothing is computed yet
+ *
+ */
+template <typename A, typename B, typename = enable_set_operator<A, B>>
+SetSymmetricDifference<expr_type<A, B>, expr_type<B, A>> operator^(const A& S1, const B& S2) {
+	return {as_expr<A, B>(S1, S2), as_expr<B, A>(S2, S1)};
+}
+
+/** Overloaded operator==: compare an expression with a Set or another expression
+ *
+ * Both streams are walked in parallel, no Set is materialized
+ * Set == Set is handled by Set::operator==
+ *
+ */
+template <typename A, typename B, typename = enable_set_operator<A, B>,
+		  typename = std::enable_if_t<is_set_expr<std::decay_t<A>>::value || is_set_expr<std::decay_t<B>>::value>>
+bool operator==(const A& S1, const B& S2) {
+	static_assert(same_set_types<expr_type<A, B>, expr_type<B, A>>::value,
+				  "operands must have the same value_type and key_compare");
+	expr_type<A, B> a{as_expr<A, B>(S1, S2)};
+	expr_type<B, A> b{as_expr<B, A>(S2, S1)};
+	auto comp = a.key_comp();
+
+	while (!a.done() && !b.done()) {
+		if (comp(a.value(), b.value()) || comp(b.value(), a.value())) return false;
+		a.next();
+		b.next();
+	}
+
+	return a.done() && b.done();
+}
+
+template <typename A, typename B, typename = enable_set_operator<A, B>,
+		  typename = std::enable_if_t<is_set_expr<std::decay_t<A>>::value || is_set_expr<std::decay_t<B>>::value>>
+bool operator!=(const A& S1, const B& S2) {
+	return !(S1 == S2);
+}
+
+/** Overloaded operator<=: subset test between an expression and a Set or another expression
+ *
+ * Both streams are walked in parallel, no Set is materialized
+ * Set <= Set is handled by Set::operator<=
+ *
+ */
+template <typename A, typename B, typename = enable_set_operator<A, B>,
+		  typename = std::enable_if_t<is_set_expr<std::decay_t<A>>::value || is_set_expr<std::decay_t<B>>::value>>
+bool operator<=(const A& S1, const B& S2) {
+	static_assert(same_set_types<expr_type<A, B>, expr_type<B, A>>::value,
+				  "operands must have the same value_type and key_compare");
+	expr_type<A, B> a{as_expr<A, B>(S1, S2)};
+	expr_type<B, A> b{as_expr<B, A>(S2, S1)};
+	auto comp = a.key_comp();
+
+	while (!a.done() && !b.done()) {
+		if (comp(a.value(), b.value())) return false;  // a value of S1 missing in S2
+
+		if (!comp(b.value(), a.value())) a.next();
+		b.next();
+	}
+
+	return a.done();
+}
+
+/** Overloaded operator<: strict subset test between an expression and a Set or another expression
+ *
+ * S1 < S2 iff S1 <= S2 and S2 has a value missing in S1
+ *
+ */
+template <typename A, typename B, typename = enable_set_operator<A, B>,
+		  typename = std::enable_if_t<is_set_expr<std::decay_t<A>>::value || is_set_expr<std::decay_t<B>>::value>>
+bool operator<(const A& S1, const B& S2) {
+	static_assert(same_set_types<expr_type<A, B>, expr_type<B, A>>::value,
+				  "operands must have the same value_type and key_compare");
+	expr_type<A, B> a{as_expr<A, B>(S1, S2)};
+	expr_type<B, A> b{as_expr<B, A>(S2, S1)};
+	auto comp = a.key_comp();
+	bool extra = false;  // S2 has a value missing in S1
+
+	while (!a.done() && !b.done()) {
+		if (comp(a.value(), b.value())) return false;
+
+		if (comp(b.value(), a.value())) extra = true;
+		else a.next();
+		b.next();
+	}
+
+	return a.done() && (extra || !b.done());
+}
+
+/** Overloaded operator<< for expressions
+ *
+ * Same format as operator<< for Set
+ *
+ */
+template <typename E>
+std::ostream& operator<<(std::ostream& os, const SetExpr<E>& expr) {
+	E e{expr.self()};
+
+	if (e.done()) {
+		os << "Set is empty!";
+	} else {
+		os << "{ ";
+		for (; !e.done(); e.next()) {
+			os << e.value() << " ";
+		}
+
+		os << "}";
+	}
+
+	return os;
+}
+
+/* ******************************************** *
+ * Evaluation of an expression into a Set       *
+ * ******************************************** */
+
+// Conversion constructor: evaluate expression expr
+template <typename T, typename Compare, typename Allocator>
+template <typename E>
+BasicSet<T, Compare, Allocator>::BasicSet(const SetExpr<E>& expr)
+	: BasicSet{expr.self().key_comp()}  // create an empty list
+{
+	OpGuard guard{*this, AllocStats::Construct};
+	Node* ptr = head;
+
+	for (E e{expr.self()}; !e.done(); e.next()) {
+		ptr->next = create_node(e.value(), nullptr, ptr);
+		ptr = ptr->next;
+		++counter;
+	}
+
+	ptr->next = tail;
+	tail->prev = ptr;
+}
@@ -0,0 +1,1300 @@
+#include <algorithm>
+#include <cassert>
+#include <thread>
+
+#include "set.h"
+#include "node.h"
+#include "sketch.h"
+#include "bloom.h"
+
+#pragma once
+
+// vectors smaller than this are sorted by a single thread
+template <typename T, typename Compare, typename Allocator>
+size_t BasicSet<T, Compare, Allocator>::parallel_threshold = 100000;
+
+// memory statistics of all sets of this type, one per instantiation of BasicSet
+// only the live nodes are counted until set_global_alloc_stats(true)
+template <typename T, typename Compare, typename Allocator>
+AllocCounter BasicSet<T, Compare, Allocator>::global_stats{false};
+
+/** Class BasicSet::OpGuard
+ *
+ * Charges the nodes allocated and freed until the guard is destroyed to operation op
+ * Nested guards keep the operation of the outermost one, e.g. the nodes freed by make_empty
+ * called from the destructor are charged to Destroy
+ *
+ */
+template <typename T, typename Compare, typename Allocator>
+class BasicSet<T, Compare, Allocator>::OpGuard {
+public:
+	OpGuard(BasicSet& S, AllocStats::Op op)
+		: S{S}, prev{S.current_op} {
+		if (S.current_op == AllocStats::Other) S.current_op = op;
+	}
+
+	// Restore the operation and record the memory used by the Set
+	~OpGuard() {
+		S.current_op = prev;
+
+		if (S.local_stats != nullptr) {
+			S.local_stats->set_live(S.counter + 2, (S.counter + 2) * sizeof(Node));
+		}
+	}
+
+	OpGuard(const OpGuard&) = delete;
+	OpGuard& operator=(const OpGuard&) = delete;
+
+private:
+	BasicSet& S;
+	AllocStats::Op prev;
+};
+
+/*****************************************************
+ * Implementation of the member functions             *
+ ******************************************************/
+
+// Used for debug purposes
+// Return number of existing nodes
+template <typename T, typename Compare, typename Allocator>
+int BasicSet<T, Compare, Allocator>::get_count_nodes() {
+	return static_cast<int>(global_stats.snapshot().live_blocks);
+}
+
+// Return the memory statistics of all sets of this type
+template <typename T, typename Compare, typename Allocator>
+AllocStats BasicSet<T, Compare, Allocator>::global_alloc_stats() {
+	return global_stats.snapshot();
+}
+
+// Turn the memory statistics of all sets of this type on or off
+template <typename T, typename Compare, typename Allocator>
+void BasicSet<T, Compare, Allocator>::set_global_alloc_stats(bool on) {
+	global_stats.set_detailed(on, sizeof(Node));
+}
+
+// Turn the memory statistics of the set on or off
+template <typename T, typename Compare, typename Allocator>
+void BasicSet<T, Compare, Allocator>::set_alloc_stats(bool on) {
+	if(on && local_stats == nullptr) {
+		local_stats = new AllocCounter{};
+		local_stats->set_live(counter + 2, (counter + 2) * sizeof(Node));
+	}
+	else if(!on) {
+		delete local_stats;
+		local_stats = nullptr;
+	}
+}
+
+// Return the memory statistics of the set
+template <typename T, typename Compare, typename Allocator>
+AllocStats BasicSet<T, Compare, Allocator>::alloc_stats() const {
+	assert(local_stats != nullptr);  // set_alloc_stats(true) must be called first
+
+	AllocStats s = local_stats->snapshot();
+	s.live_blocks = counter + 2;
+	s.live_bytes = s.live_blocks * sizeof(Node);
+	s.peak_bytes = std::max(s.peak_bytes, s.live_bytes);
+
+	return s;
+}
+
+// Default constructor
+template <typename T, typename Compare, typename Allocator>
+BasicSet<T, Compare, Allocator>::BasicSet()
+	: BasicSet{Compare{}, Allocator{}}
+{
+}
+
+// Constructor with an ordering and an allocator
+template <typename T, typename Compare, typename Allocator>
+BasicSet<T, Compare, Allocator>::BasicSet(const Compare& comp, const Allocator& alloc)
+	: counter{0}, comp{comp}, alloc{alloc}, refs{nullptr}, sketch_ptr{nullptr}, sketch_valid{false}, bloom{nullptr},
+	  local_stats{nullptr}, current_op{AllocStats::Other}
+{
+	OpGuard guard{*this, AllocStats::Construct};
+	init_dummy_nodes();
+}
+
+// Constructor with an allocator
+template <typename T, typename Compare, typename Allocator>
+BasicSet<T, Compare, Allocator>::BasicSet(const Allocator& alloc)
+	: BasicSet{Compare{}, alloc}
+{
+}
+
+// Conversion constructor
+template <typename T, typename Compare, typename Allocator>
+BasicSet<T, Compare, Allocator>::BasicSet(const T& val)
+	: BasicSet{}  // create an empty list
+{
+	OpGuard guard{*this, AllocStats::Construct};
+	insert(tail, val);
+}
+
+// Constructor to create a Set from a sorted vector v
+template <typename T, typename Compare, typename Allocator>
+BasicSet<T, Compare, Allocator>::BasicSet(const std::vector<T>& v)
+	: BasicSet{}  // create an empty list
+{
+	assert(std::adjacent_find(v.begin(), v.end(), [this](const T& a, const T& b) { return !comp(a, b); }) == v.end());
+
+	OpGuard guard{*this, AllocStats::Construct};
+	append_sorted(v);
+}
+
+// Create a Set from an unsorted vector, with repetitions
+template <typename T, typename Compare, typename Allocator>
+BasicSet<T, Compare, Allocator> BasicSet<T, Compare, Allocator>::from_unsorted(std::vector<T> values, const Compare& comp,
+																			   const Allocator& alloc) {
+	return BasicSet{Unsorted{}, values, comp, alloc};  // no copy, the Set is built in place
+}
+
+// Constructor used by from_unsorted, values is sorted in place
+template <typename T, typename Compare, typename Allocator>
+BasicSet<T, Compare, Allocator>::BasicSet(Unsorted, std::vector<T>& values, const Compare& comp, const Allocator& alloc)
+	: BasicSet{comp, alloc}
+{
+	OpGuard guard{*this, AllocStats::Construct};
+
+	sort_unique(values);
+	append_sorted(values);
+}
+
+// Make the set empty
+template <typename T, typename Compare, typename Allocator>
+void BasicSet<T, Compare, Allocator>::make_empty() {
+	if(head->next == tail) return;
+
+	OpGuard guard{*this, AllocStats::Clear};
+
+	// Leave the shared nodes to the other copies, instead of cloning them
+	if(is_shared()) {
+		*this = BasicSet{comp, alloc};
+
+		if(sketch_ptr != nullptr) {
+			*sketch_ptr = SetSketch{};
+			sketch_valid = true;
+		}
+
+		if(bloom != nullptr) {
+			bloom->clear();
+		}
+		return;
+	}
+
+	Node* ptr = head->next;
+
+	while(ptr != tail) {
+		ptr = ptr->next;
+		destroy_node(ptr->prev);
+	}
+
+	head->next = tail;
+	tail->prev = head;
+	counter = 0;
+
+	if(sketch_ptr != nullptr) {
+		*sketch_ptr = SetSketch{};
+		sketch_valid = true;
+	}
+
+	if(bloom != nullptr) {
+		bloom->clear();
+	}
+}
+
+// Insert val, if it does not belong to the set
+template <typename T, typename Compare, typename Allocator>
+bool BasicSet<T, Compare, Allocator>::insert(const T& val) {
+	OpGuard guard{*this, AllocStats::Insert};
+	bool keep_sketch = sketch_valid;
+	prepare_mutation();
+
+	Node* ptr = head->next;
+
+	while(ptr != tail && comp(ptr->value, val)) {
+		ptr = ptr->next;
+	}
+
+	if(keep_sketch) {
+		sketch_add(val);
+		sketch_valid = true;
+	}
+
+	if(ptr != tail && !comp(val, ptr->value)) return false;
+
+	insert(ptr, val);
+	bloom_add(val);
+	return true;
+}
+
+// Remove val, if it belongs to the set
+template <typename T, typename Compare, typename Allocator>
+bool BasicSet<T, Compare, Allocator>::erase(const T& val) {
+	OpGuard guard{*this, AllocStats::Erase};
+	prepare_mutation();
+
+	Node* ptr = head->next;
+
+	while(ptr != tail && comp(ptr->value, val)) {
+		ptr = ptr->next;
+	}
+
+	if(ptr == tail || comp(val, ptr->value)) return false;
+
+	remove(ptr);
+	return true;
+}
+
+// Insert an unsorted batch of values with one merge
+template <typename T, typename Compare, typename Allocator>
+size_t BasicSet<T, Compare, Allocator>::insert_batch(std::vector<T> values) {
+	OpGuard guard{*this, AllocStats::Insert};
+	sort_unique(values);
+
+	bool keep_sketch = sketch_valid;
+	prepare_mutation();
+
+	if(keep_sketch) {
+		for(const T& val : values) sketch_add(val);
+		sketch_valid = true;
+	}
+
+	size_t old_counter = counter;
+	Node* ptr = head->next;
+	auto it = values.begin();
+
+	while(it != values.end() && ptr != tail) {
+		if(comp(ptr->value, *it)) {
+			ptr = ptr->next;
+			continue;
+		}
+
+		if(comp(*it, ptr->value)) insert(ptr, *it);
+		++it;
+	}
+
+	for(; it != values.end(); ++it) {
+		insert(tail, *it);
+	}
+
+	if(bloom != nullptr) {
+		for(const T& val : values) bloom_add(val);
+	}
+
+	return counter - old_counter;
+}
+
+// Remove an unsorted batch of values with one merge
+template <typename T, typename Compare, typename Allocator>
+size_t BasicSet<T, Compare, Allocator>::erase_batch(std::vector<T> values) {
+	OpGuard guard{*this, AllocStats::Erase};
+	sort_unique(values);
+	prepare_mutation();
+
+	size_t old_counter = counter;
+	Node* ptr = head->next;
+	auto it = values.begin();
+
+	while(it != values.end() && ptr != tail) {
+		if(comp(ptr->value, *it)) {
+			ptr = ptr->next;
+			continue;
+		}
+
+		if(!comp(*it, ptr->value)) {
+			ptr = ptr->next;
+			remove(ptr->prev);
+		}
+		++it;
+	}
+
+	rebuild_bloom_filter();
+	return old_counter - counter;
+}
+
+// Move the values not smaller than val into a new Set
+template <typename T, typename Compare, typename Allocator>
+BasicSet<T, Compare, Allocator> BasicSet<T, Compare, Allocator>::split_at(const T& val) {
+	OpGuard guard{*this, AllocStats::Erase};
+	BasicSet upper{comp, alloc};
+
+	prepare_mutation();
+
+	Node* first = head->next;
+	size_t n = 0;
+
+	while(first != tail && comp(first->value, val)) {
+		first = first->next;
+		++n;
+	}
+
+	if(first == tail) return upper;
+
+	// Relink [first, tail) between the dummy nodes of upper
+	Node* last = tail->prev;
+
+	upper.head->next = first;
+	upper.tail->prev = last;
+	last->next = upper.tail;
+	upper.counter = counter - n;
+
+	tail->prev = first->prev;
+	first->prev->next = tail;
+	first->prev = upper.head;
+	counter = n;
+
+	rebuild_bloom_filter();
+	return upper;
+}
+
+// Move the values satisfying pred into a new Set
+template <typename T, typename Compare, typename Allocator>
+template <typename Pred>
+BasicSet<T, Compare, Allocator> BasicSet<T, Compare, Allocator>::extract_if(Pred pred) {
+	OpGuard guard{*this, AllocStats::Erase};
+	BasicSet extracted{comp, alloc};
+
+	prepare_mutation();
+
+	Node* ptr = head->next;
+
+	while(ptr != tail) {
+		ptr = ptr->next;
+		if(pred(ptr->prev->value)) move_node(ptr->prev, extracted);
+	}
+
+	if(!extracted.is_empty()) rebuild_bloom_filter();
+	return extracted;
+}
+
+template <typename T, typename Compare, typename Allocator>
+BasicSet<T, Compare, Allocator>::~BasicSet() {
+	delete local_stats;
+	local_stats = nullptr;
+
+	OpGuard guard{*this, AllocStats::Destroy};
+
+	// The nodes are still used by other copies
+	if(refs != nullptr && refs->fetch_sub(1) > 1) return;
+
+	// Member function make_empty() can be used to implement the destructor
+	// IMPLEMENT before HA session on week 16
+	make_empty();
+	destroy_node(head);
+	destroy_node(tail);
+	delete refs;
+}
+
+// Copy constructor
+template <typename T, typename Compare, typename Allocator>
+BasicSet<T, Compare, Allocator>::BasicSet(const BasicSet& source)
+	: head{source.head}, tail{source.tail}, counter{source.counter}, comp{source.comp},
+	  alloc{NodeTraits::select_on_container_copy_construction(source.alloc)}, refs{source.refs},
+	  sketch_ptr{nullptr}, sketch_valid{false}, bloom{source.bloom},
+	  local_stats{nullptr}, current_op{AllocStats::Other}
+{
+	OpGuard guard{*this, AllocStats::Copy};
+
+	// source.sketch() may be rebuilding the sketches in another thread
+	{
+		std::lock_guard<std::mutex> lock{source.sketch_mutex};
+		sketch_ptr = source.sketch_ptr;
+		sketch_valid = source.sketch_valid;
+	}
+
+	// A copy of a copy-on-write Set shares its nodes, its sketches and its Bloom filter
+	if(refs != nullptr) {
+		++*refs;
+		return;
+	}
+
+	init_dummy_nodes();
+	clone_nodes(source.head->next, source.tail);
+	clone_summaries();
+}
+
+// Move constructor, source is left with the dummy nodes of an empty list
+template <typename T, typename Compare, typename Allocator>
+BasicSet<T, Compare, Allocator>::BasicSet(BasicSet&& source)
+	: BasicSet{source.comp, source.alloc}
+{
+	std::swap(head, source.head);
+	std::swap(tail, source.tail);
+	std::swap(counter, source.counter);
+	std::swap(refs, source.refs);
+	std::swap(sketch_ptr, source.sketch_ptr);
+	std::swap(sketch_valid, source.sketch_valid);
+	std::swap(bloom, source.bloom);
+}
+
+// Copy-and-swap assignment operator
+// *this stays in copy-on-write mode, and keeps its sketch, Bloom filter and memory statistics, if it had them
+// The nodes are swapped together with the allocator that created them
+template <typename T, typename Compare, typename Allocator>
+BasicSet<T, Compare, Allocator>& BasicSet<T, Compare, Allocator>::operator=(BasicSet source) {
+	bool cow = (refs != nullptr);
+	bool sketching = (sketch_ptr != nullptr);
+	double fp_rate = (bloom != nullptr) ? bloom->fp_rate() : 0.0;
+
+	std::swap(head, source.head);
+	std::swap(tail, source.tail);
+	std::swap(comp, source.comp);
+	std::swap(alloc, source.alloc);
+	std::swap(refs, source.refs);
+	std::swap(sketch_ptr, source.sketch_ptr);
+	std::swap(sketch_valid, source.sketch_valid);
+	std::swap(bloom, source.bloom);
+
+	counter = source.counter;
+
+	if(cow && refs == nullptr) {
+		refs = new std::atomic<size_t>{1};
+	}
+
+	if(sketching && sketch_ptr == nullptr) {
+		sketch_ptr = std::make_shared<SetSketch>();
+		sketch_valid = false;  // rebuilt when needed
+	}
+	else if(!sketching && sketch_ptr != nullptr) {
+		std::swap(sketch_ptr, source.sketch_ptr);
+	}
+
+	if(fp_rate > 0.0 && bloom == nullptr) {
+		if constexpr(hashable) set_bloom_filter(fp_rate);
+	}
+	else if(fp_rate == 0.0 && bloom != nullptr) {
+		std::swap(bloom, source.bloom);
+	}
+
+	return *this;
+}
+
+// Turn copy-on-write on or off
+template <typename T, typename Compare, typename Allocator>
+void BasicSet<T, Compare, Allocator>::set_copy_on_write(bool on) {
+	if(on && refs == nullptr) {
+		refs = new std::atomic<size_t>{1};
+	}
+	else if(!on && refs != nullptr) {
+		OpGuard guard{*this, AllocStats::Copy};
+		prepare_mutation();
+		delete refs;
+		refs = nullptr;
+	}
+}
+
+// Return true, if copies of the set share its nodes
+template <typename T, typename Compare, typename Allocator>
+bool BasicSet<T, Compare, Allocator>::is_copy_on_write() const {
+	return (refs != nullptr);
+}
+
+// Return true, if the nodes are shared with other copies
+template <typename T, typename Compare, typename Allocator>
+bool BasicSet<T, Compare, Allocator>::is_shared() const {
+	return (refs != nullptr && *refs > 1);
+}
+
+// Turn the sketches on or off
+template <typename T, typename Compare, typename Allocator>
+void BasicSet<T, Compare, Allocator>::set_sketching(bool on) {
+	static_assert(hashable, "sketches require integral values ordered by std::less or std::greater");
+
+	if(on && sketch_ptr == nullptr) {
+		sketch_ptr = std::make_shared<SetSketch>();
+		sketch_valid = false;
+	}
+	else if(!on) {
+		sketch_ptr = nullptr;
+		sketch_valid = false;
+	}
+}
+
+// Return the sketches of the set, rebuilt if an operation invalidated them
+// Concurrent calls are serialized by sketch_mutex, so the sketches are rebuilt once
+template <typename T, typename Compare, typename Allocator>
+const SetSketch& BasicSet<T, Compare, Allocator>::sketch() const {
+	static_assert(hashable, "sketches require integral values ordered by std::less or std::greater");
+	std::lock_guard<std::mutex> lock{sketch_mutex};
+	assert(sketch_ptr != nullptr);  // set_sketching(true) must be called first
+
+	// A new object, the old one may be shared with other copies
+	if(!sketch_valid) {
+		sketch_ptr = std::make_shared<SetSketch>(*this);
+		sketch_valid = true;
+	}
+
+	return *sketch_ptr;
+}
+
+// Turn the Bloom filter on, with the given false-positive budget, or off
+template <typename T, typename Compare, typename Allocator>
+void BasicSet<T, Compare, Allocator>::set_bloom_filter(double fp_rate) {
+	static_assert(hashable, "the Bloom filter requires integral values ordered by std::less or std::greater");
+
+	bloom = nullptr;
+
+	if(fp_rate > 0.0) {
+		bloom = std::make_shared<BlockedBloomFilter>(2 * counter, fp_rate);
+		for(const T& val : *this) bloom->add(val);
+	}
+}
+
+// Return the Bloom filter, nullptr if it is off
+template <typename T, typename Compare, typename Allocator>
+const BlockedBloomFilter* BasicSet<T, Compare, Allocator>::bloom_filter() const {
+	return bloom.get();
+}
+
+// Return the ordering of the values
+template <typename T, typename Compare, typename Allocator>
+Compare BasicSet<T, Compare, Allocator>::key_comp() const {
+	return comp;
+}
+
+// Return the allocator of the values
+template <typename T, typename Compare, typename Allocator>
+Allocator BasicSet<T, Compare, Allocator>::get_allocator() const {
+	return Allocator{alloc};
+}
+
+// Test whether a set is empty
+template <typename T, typename Compare, typename Allocator>
+bool BasicSet<T, Compare, Allocator>::is_empty() const {
+	return (counter == 0);
+}
+
+// Test set membership
+template <typename T, typename Compare, typename Allocator>
+bool BasicSet<T, Compare, Allocator>::is_member(const T& val) const {
+	size_t steps = 0;
+	bool found = find_value(val, steps);
+
+	global_stats.walked(steps);
+	if(local_stats != nullptr) local_stats->walked(steps);
+
+	return found;
+}
+
+// Search val in the list, steps is the number of nodes visited
+template <typename T, typename Compare, typename Allocator>
+bool BasicSet<T, Compare, Allocator>::find_value(const T& val, size_t& steps) const {
+	if(head->next == tail ) return false;
+	if(comp(val, head->next->value) || comp(tail->prev->value, val)) return false;
+
+	// Most absent values are rejected without walking the list
+	if constexpr(hashable) {
+		if(bloom != nullptr && !bloom->might_contain(val)) return false;
+	}
+
+	Node* ptr = head->next;
+	while(ptr != tail && comp(ptr->value, val)){
+		ptr = ptr->next;
+		++steps;
+	}
+
+	++steps;  // the node compared last
+	if(!comp(val, ptr->value)) return true;
+
+	if(bloom != nullptr) bloom->record_false_positive();
+	return false;
+}
+
+// Return number of elements in the set
+template <typename T, typename Compare, typename Allocator>
+size_t BasicSet<T, Compare, Allocator>::cardinality() const {
+	return counter;
+}
+
+// Return true, if the set is a subset of b, otherwise false
+// a <= b if every member of a is a member of b
+template <typename T, typename Compare, typename Allocator>
+bool BasicSet<T, Compare, Allocator>::operator<=(const BasicSet& b) const {
+	if(counter > b.counter) return false;
+
+	return is_subset(head->next, tail, b.head->next, b.tail);
+}
+
+// Return true, if the set is equal to set b
+// Both lists are walked once, side by side
+template <typename T, typename Compare, typename Allocator>
+bool BasicSet<T, Compare, Allocator>::operator==(const BasicSet& b) const {
+	if(counter != b.counter) return false;
+
+	Node* ptr_this = head->next;
+	Node* ptr_b = b.head->next;
+
+	while(ptr_this != tail) {
+		if(!equal(ptr_this->value, ptr_b->value)) return false;
+		ptr_this = ptr_this->next;
+		ptr_b = ptr_b->next;
+	}
+
+	return true;
+}
+
+// Return true, if the set is different from set b
+template <typename T, typename Compare, typename Allocator>
+bool BasicSet<T, Compare, Allocator>::operator!=(const BasicSet& b) const {
+	return !(*this == b);
+}
+
+// Return true, if the set is a strict subset of S, otherwise false
+// a == b, iff a <= b but not b <= a
+template <typename T, typename Compare, typename Allocator>
+bool BasicSet<T, Compare, Allocator>::operator<(const BasicSet& b) const {
+	// if(counter == b.counter) return false;
+	return (counter != b.counter && *this <= b);
+}
+
+// Classify how the set relates to set b
+template <typename T, typename Compare, typename Allocator>
+typename BasicSet<T, Compare, Allocator>::Relation BasicSet<T, Compare, Allocator>::relation(const BasicSet& b) const {
+	Node* ptr_this = head->next;
+	Node* ptr_b = b.head->next;
+
+	bool only_this = false;  // some value belongs only to *this
+	bool only_b = false;     // some value belongs only to b
+	bool common = false;     // some value belongs to both
+
+	while(ptr_this != tail && ptr_b != b.tail) {
+		if(comp(ptr_this->value, ptr_b->value)) {
+			only_this = true;
+			ptr_this = ptr_this->next;
+		}
+		else if(comp(ptr_b->value, ptr_this->value)) {
+			only_b = true;
+			ptr_b = ptr_b->next;
+		}
+		else {
+			common = true;
+			ptr_this = ptr_this->next;
+			ptr_b = ptr_b->next;
+		}
+
+		if(only_this && only_b && common) return Relation::Overlapping;
+	}
+
+	only_this = only_this || ptr_this != tail;
+	only_b = only_b || ptr_b != b.tail;
+
+	if(!only_this && !only_b) return Relation::Equal;
+	if(!only_this) return Relation::Subset;
+	if(!only_b) return Relation::Superset;
+	if(!common) return Relation::Disjoint;
+
+	return Relation::Overlapping;
+}
+
+// Return the number of values in both sets
+template <typename T, typename Compare, typename Allocator>
+size_t BasicSet<T, Compare, Allocator>::intersection_size(const BasicSet& b) const {
+	Node* ptr_this = head->next;
+	Node* ptr_b = b.head->next;
+	size_t n = 0;
+
+	while(ptr_this != tail && ptr_b != b.tail) {
+		if(comp(ptr_this->value, ptr_b->value)) {
+			ptr_this = ptr_this->next;
+		}
+		else if(comp(ptr_b->value, ptr_this->value)) {
+			ptr_b = ptr_b->next;
+		}
+		else {
+			++n;
+			ptr_this = ptr_this->next;
+			ptr_b = ptr_b->next;
+		}
+	}
+
+	return n;
+}
+
+// Return the number of values in any of the sets
+template <typename T, typename Compare, typename Allocator>
+size_t BasicSet<T, Compare, Allocator>::union_size(const BasicSet& b) const {
+	return counter + b.counter - intersection_size(b);
+}
+
+// Return the Jaccard similarity of the sets
+template <typename T, typename Compare, typename Allocator>
+double BasicSet<T, Compare, Allocator>::jaccard(const BasicSet& b) const {
+	size_t n = intersection_size(b);
+	size_t u = counter + b.counter - n;
+
+	return (u == 0) ? 1.0 : static_cast<double>(n) / u;
+}
+
+// Return true, if the sets have no common values
+template <typename T, typename Compare, typename Allocator>
+bool BasicSet<T, Compare, Allocator>::is_disjoint(const BasicSet& b) const {
+	Node* ptr_this = head->next;
+	Node* ptr_b = b.head->next;
+
+	while(ptr_this != tail && ptr_b != b.tail) {
+		if(comp(ptr_this->value, ptr_b->value)) ptr_this = ptr_this->next;
+		else if(comp(ptr_b->value, ptr_this->value)) ptr_b = ptr_b->next;
+		else return false;
+	}
+
+	return true;
+}
+
+// Modify *this such that it becomes the union of *this with Set S
+// Add to *this all elements in Set S (repeated elements are not allowed)
+template <typename T, typename Compare, typename Allocator>
+BasicSet<T, Compare, Allocator>& BasicSet<T, Compare, Allocator>::operator+=(const BasicSet& S) {
+	if(is_empty()) {
+		OpGuard guard{*this, AllocStats::Union};
+		*this = S;
+		return *this;
+	}
+
+	OpGuard guard{*this, AllocStats::Union};
+	bool keep_sketch = sketch_valid;
+	prepare_mutation();
+	merge_union(S.head->next, S.tail);
+
+	// The sketch of a union is the union of the sketches
+	// S is read under its lock, S.sketch() may be rebuilding them in another thread
+	if(keep_sketch) {
+		std::lock_guard<std::mutex> lock{S.sketch_mutex};
+
+		if(S.sketch_valid) {
+			*sketch_ptr += *S.sketch_ptr;
+		}
+		else {
+			for(const T& val : S) sketch_add(val);
+		}
+		sketch_valid = true;
+	}
+
+	if(bloom != nullptr) {
+		for(const T& val : S) bloom_add(val);
+	}
+
+	return *this;
+}
+
+// Modify *this such that it becomes the intersection of *this with Set S
+template <typename T, typename Compare, typename Allocator>
+BasicSet<T, Compare, Allocator>& BasicSet<T, Compare, Allocator>::operator*=(const BasicSet& S) {
+	OpGuard guard{*this, AllocStats::Intersection};
+
+	if(is_empty() || S.is_empty()) {
+		*this = BasicSet{comp, alloc};
+		return *this;
+	}
+
+	prepare_mutation();
+	merge_intersection(S.head->next, S.tail);
+	rebuild_bloom_filter();
+	return *this;
+}
+
+// Modify *this such that it becomes the Set difference between Set *this and Set S
+template <typename T, typename Compare, typename Allocator>
+BasicSet<T, Compare, Allocator>& BasicSet<T, Compare, Allocator>::operator-=(const BasicSet& S) {
+	if(is_empty()) {
+		return *this;
+	}
+
+	OpGuard guard{*this, AllocStats::Difference};
+	prepare_mutation();
+	merge_difference(S.head->next, S.tail);
+	rebuild_bloom_filter();
+	return *this;
+}
+
+// Modify *this such that it becomes the symmetric difference of Set *this and Set S
+template <typename T, typename Compare, typename Allocator>
+BasicSet<T, Compare, Allocator>& BasicSet<T, Compare, Allocator>::operator^=(const BasicSet& S) {
+	OpGuard guard{*this, AllocStats::SymmetricDifference};
+
+	if(this == &S) {
+		make_empty();
+		return *this;
+	}
+
+	prepare_mutation();
+	merge_symmetric_difference(S.head->next, S.tail);
+	rebuild_bloom_filter();
+	return *this;
+}
+
+// Set the number of values from which the batches are sorted in parallel
+template <typename T, typename Compare, typename Allocator>
+void BasicSet<T, Compare, Allocator>::set_parallel_threshold(size_t n) {
+	parallel_threshold = n;
+}
+
+// Iterator to the smallest value
+template <typename T, typename Compare, typename Allocator>
+typename BasicSet<T, Compare, Allocator>::Iterator BasicSet<T, Compare, Allocator>::begin() const {
+	return Iterator{head->next};
+}
+
+// Iterator to the dummy tail node
+template <typename T, typename Compare, typename Allocator>
+typename BasicSet<T, Compare, Allocator>::Iterator BasicSet<T, Compare, Allocator>::end() const {
+	return Iterator{tail};
+}
+
+// Iterator to the first value not smaller than val
+template <typename T, typename Compare, typename Allocator>
+typename BasicSet<T, Compare, Allocator>::Iterator BasicSet<T, Compare, Allocator>::lower_bound(const T& val) const {
+	Node* ptr = head->next;
+
+	while(ptr != tail && comp(ptr->value, val)) {
+		ptr = ptr->next;
+	}
+
+	return Iterator{ptr};
+}
+
+// Iterator to the first value larger than val
+template <typename T, typename Compare, typename Allocator>
+typename BasicSet<T, Compare, Allocator>::Iterator BasicSet<T, Compare, Allocator>::upper_bound(const T& val) const {
+	Node* ptr = head->next;
+
+	while(ptr != tail && !comp(val, ptr->value)) {
+		ptr = ptr->next;
+	}
+
+	return Iterator{ptr};
+}
+
+// View of the values in [lo, hi]
+template <typename T, typename Compare, typename Allocator>
+typename BasicSet<T, Compare, Allocator>::Range BasicSet<T, Compare, Allocator>::values_between(const T& lo, const T& hi) const {
+	if(comp(hi, lo)) return Range{end(), end()};
+
+	Iterator first = lower_bound(lo);
+	Iterator last = first;
+
+	while(last != end() && !comp(hi, *last)) {
+		++last;
+	}
+
+	return Range{first, last};
+}
+
+/* ******************************************** *
+ * Private Member Functions -- Implementation   *
+ * ******************************************** */
+
+// Allocate and construct a node with the allocator of the set
+template <typename T, typename Compare, typename Allocator>
+typename BasicSet<T, Compare, Allocator>::Node* BasicSet<T, Compare, Allocator>::create_node(const T& val, Node* next, Node* prev) {
+	Node* ptr = NodeTraits::allocate(alloc, 1);
+	NodeTraits::construct(alloc, ptr, val, next, prev);
+
+	global_stats.allocated(current_op, sizeof(Node));
+	if(local_stats != nullptr) local_stats->allocated(current_op, sizeof(Node));
+
+	return ptr;
+}
+
+// Destroy and deallocate a node created by create_node
+template <typename T, typename Compare, typename Allocator>
+void BasicSet<T, Compare, Allocator>::destroy_node(Node* ptr) {
+	global_stats.freed(current_op, sizeof(Node));
+	if(local_stats != nullptr) local_stats->freed(current_op, sizeof(Node));
+
+	NodeTraits::destroy(alloc, ptr);
+	NodeTraits::deallocate(alloc, ptr, 1);
+}
+
+// Append the values of sorted vector v, larger than all values in the Set, at the end of the list
+template <typename T, typename Compare, typename Allocator>
+void BasicSet<T, Compare, Allocator>::append_sorted(const std::vector<T>& v) {
+	Node* ptr = tail->prev;
+
+	for(const T& item : v) {
+		ptr->next = create_node(item, nullptr, ptr);
+		ptr = ptr->next;
+		++counter;
+	}
+	ptr->next = tail;
+	tail->prev = ptr;
+}
+
+// Create the dummy nodes of an empty list
+template <typename T, typename Compare, typename Allocator>
+void BasicSet<T, Compare, Allocator>::init_dummy_nodes() {
+	head = create_node(T{}, nullptr, nullptr);
+	tail = create_node(T{}, nullptr, nullptr);
+	head->next = tail;
+	tail->prev = head;
+}
+
+// Two values are equal if none of them is smaller than the other one
+template <typename T, typename Compare, typename Allocator>
+bool BasicSet<T, Compare, Allocator>::equal(const T& a, const T& b) const {
+	return !comp(a, b) && !comp(b, a);
+}
+
+//If you add any private member functions to class Set then write the implementation here
+template <typename T, typename Compare, typename Allocator>
+void BasicSet<T, Compare, Allocator>::insert(Node *ptr, const T& val) {
+    ptr->prev = ptr->prev->next = create_node(val, ptr, ptr->prev);
+    counter++;
+}
+
+// Called by every member function modifying the nodes, before it touches them
+// Give *this its own copy of the nodes, the sketches and the Bloom filter, if they are shared with other copies
+// The sketches are invalidated, operations that can update them do it afterwards
+template <typename T, typename Compare, typename Allocator>
+void BasicSet<T, Compare, Allocator>::prepare_mutation() {
+	sketch_valid = false;
+
+	if(!is_shared()) return;
+
+	BasicSet copy{comp, alloc};
+	copy.current_op = current_op;
+	copy.local_stats = local_stats;
+	copy.clone_nodes(head->next, tail);
+	copy.local_stats = nullptr;
+
+	// copy takes over the reference to the shared nodes and drops it when destroyed
+	std::swap(head, copy.head);
+	std::swap(tail, copy.tail);
+	std::swap(refs, copy.refs);
+	refs = new std::atomic<size_t>{1};
+
+	clone_summaries();
+}
+
+// Replace the sketches and the Bloom filter by copies owned by *this only
+template <typename T, typename Compare, typename Allocator>
+void BasicSet<T, Compare, Allocator>::clone_summaries() {
+	if(sketch_ptr != nullptr) sketch_ptr = std::make_shared<SetSketch>(*sketch_ptr);
+	if(bloom != nullptr) bloom = std::make_shared<BlockedBloomFilter>(*bloom);
+}
+
+// Append a copy of the nodes [first, last) of another Set to the empty list head..tail
+template <typename T, typename Compare, typename Allocator>
+void BasicSet<T, Compare, Allocator>::clone_nodes(const Node* first, const Node* last) {
+	Node* ptr_this = head;
+
+	while(first != last) {
+		ptr_this->next = create_node(first->value, nullptr, ptr_this);
+		first = first->next;
+		ptr_this = ptr_this->next;
+	}
+
+	ptr_this->next = tail;
+	tail->prev = ptr_this;
+}
+
+// Add val to the sketches, only called when they are on
+template <typename T, typename Compare, typename Allocator>
+void BasicSet<T, Compare, Allocator>::sketch_add(const T& val) {
+	if constexpr(hashable) sketch_ptr->add(val);
+}
+
+// Add val to the Bloom filter, if it is on
+// The filter is rebuilt twice as large when it holds more values than it was sized for
+template <typename T, typename Compare, typename Allocator>
+void BasicSet<T, Compare, Allocator>::bloom_add(const T& val) {
+	if constexpr(hashable) {
+		if(bloom == nullptr) return;
+
+		if(counter > bloom->capacity()) {
+			rebuild_bloom_filter();
+		}
+		else {
+			bloom->add(val);
+		}
+	}
+}
+
+// Rebuild the Bloom filter from the values in the set, if it is on
+// Removed values are not deleted from a Bloom filter, so this is done after removing many values
+template <typename T, typename Compare, typename Allocator>
+void BasicSet<T, Compare, Allocator>::rebuild_bloom_filter() {
+	if constexpr(hashable) {
+		if(bloom != nullptr) {
+			set_bloom_filter(bloom->fp_rate());
+		}
+	}
+}
+
+// Remove the Node pointed by p
+template <typename T, typename Compare, typename Allocator>
+void BasicSet<T, Compare, Allocator>::remove(Node* ptr) {
+    ptr->prev->next = ptr->next;
+    ptr->next->prev = ptr->prev;
+    counter--;
+
+    destroy_node(ptr);  // deallocate the memory
+}
+
+// Unlink the Node pointed by ptr and append it to Set S, whose values must be smaller
+template <typename T, typename Compare, typename Allocator>
+void BasicSet<T, Compare, Allocator>::move_node(Node* ptr, BasicSet& S) {
+	ptr->prev->next = ptr->next;
+	ptr->next->prev = ptr->prev;
+	--counter;
+
+	ptr->next = S.tail;
+	ptr->prev = S.tail->prev;
+	S.tail->prev = S.tail->prev->next = ptr;
+	++S.counter;
+}
+
+// Merge the nodes [first, last) of another Set into *this
+template <typename T, typename Compare, typename Allocator>
+void BasicSet<T, Compare, Allocator>::merge_union(const Node* first, const Node* last) {
+	Node* ptr_this = head->next;
+
+	while(first != last && ptr_this != tail) {
+		if(comp(ptr_this->value, first->value)) {
+			ptr_this = ptr_this->next;
+		}
+		else if(comp(first->value, ptr_this->value)) {
+			insert(ptr_this, first->value);
+			first = first->next;
+		}
+		else {
+			ptr_this = ptr_this->next;
+			first = first->next;
+		}
+	}
+
+	// if the range is larger than *this
+	while(first != last) {
+		insert(tail, first->value);
+		first = first->next;
+	}
+}
+
+// Remove from *this all values that do not belong to the nodes [first, last) of another Set
+template <typename T, typename Compare, typename Allocator>
+void BasicSet<T, Compare, Allocator>::merge_intersection(const Node* first, const Node* last) {
+	Node* ptr_this = head->next;
+
+	while(ptr_this != tail && first != last) {
+		if(comp(ptr_this->value, first->value)) {
+			ptr_this = ptr_this->next;
+			remove(ptr_this->prev);
+			continue;
+		}
+
+		if(comp(first->value, ptr_this->value)) {
+			first = first->next;
+			continue;
+		}
+
+		ptr_this = ptr_this->next;
+		first = first->next;
+	}
+
+	//Remove the rest of *this if the range ended first
+	while(ptr_this != tail) {
+		ptr_this = ptr_this->next;
+		remove(ptr_this->prev);
+	}
+}
+
+// Remove from *this all values that belong to the nodes [first, last) of another Set
+template <typename T, typename Compare, typename Allocator>
+void BasicSet<T, Compare, Allocator>::merge_difference(const Node* first, const Node* last) {
+	Node* ptr_this = head->next;
+
+	while(first != last && ptr_this != tail) {
+		if(comp(first->value, ptr_this->value)) {
+			first = first->next;
+			continue;
+		}
+		if(comp(ptr_this->value, first->value)) {
+			ptr_this = ptr_this->next;
+			continue;
+		}
+
+		ptr_this = ptr_this->next;
+		first = first->next;
+		remove(ptr_this->prev);
+	}
+}
+
+// Insert into *this the values of the nodes [first, last) of another Set not in *this, and remove the common values
+template <typename T, typename Compare, typename Allocator>
+void BasicSet<T, Compare, Allocator>::merge_symmetric_difference(const Node* first, const Node* last) {
+	Node* ptr_this = head->next;
+
+	while(first != last && ptr_this != tail) {
+		if(comp(ptr_this->value, first->value)) {
+			ptr_this = ptr_this->next;
+		}
+		else if(comp(first->value, ptr_this->value)) {
+			insert(ptr_this, first->value);
+			first = first->next;
+		}
+		else {
+			ptr_this = ptr_this->next;
+			first = first->next;
+			remove(ptr_this->prev);
+		}
+	}
+
+	// if the range is larger than *this
+	while(first != last) {
+		insert(tail, first->value);
+		first = first->next;
+	}
+}
+
+// Return true, if every value in the nodes [first, last) belongs to the nodes [s_first, s_last)
+template <typename T, typename Compare, typename Allocator>
+bool BasicSet<T, Compare, Allocator>::is_subset(const Node* first, const Node* last, const Node* s_first, const Node* s_last) const {
+	while(first != last && s_first != s_last) {
+		if(comp(s_first->value, first->value)) {
+			s_first = s_first->next;
+			continue;
+		}
+
+		if(comp(first->value, s_first->value)) return false;
+		first = first->next;
+		s_first = s_first->next;
+	}
+
+	return (first == last);
+}
+
+// Number of chunks sorted in parallel, one per hardware thread
+// Return 2, if the number of hardware threads is unknown
+template <typename T, typename Compare, typename Allocator>
+size_t BasicSet<T, Compare, Allocator>::number_of_parts() {
+	size_t n = std::thread::hardware_concurrency();
+	return (n == 0) ? 2 : n;
+}
+
+// Sort v and remove repeated values
+// Integral values are radix sorted, other large vectors are sorted in chunks by one thread each,
+// then the chunks are merged pairwise
+template <typename T, typename Compare, typename Allocator>
+void BasicSet<T, Compare, Allocator>::sort_unique(std::vector<T>& v) const {
+	size_t n = number_of_parts();
+
+	if constexpr (hashable) {
+		if(v.size() >= radix_threshold) {
+			radix_sort(v);
+			v.erase(std::unique(v.begin(), v.end()), v.end());
+			return;
+		}
+	}
+
+	if(v.size() < parallel_threshold || n == 1) {
+		std::sort(v.begin(), v.end(), comp);
+	}
+	else {
+		std::vector<size_t> bounds;
+		for(size_t i = 0; i <= n; ++i) {
+			bounds.push_back(v.size() * i / n);
+		}
+
+		std::vector<std::thread> workers;
+		for(size_t i = 0; i < n; ++i) {
+			workers.emplace_back([this, &v, &bounds, i]() {
+				std::sort(v.begin() + bounds[i], v.begin() + bounds[i + 1], comp);
+			});
+		}
+		for(auto& w : workers) w.join();
+
+		// Merge neighbouring chunks, doubling the chunk length in each round
+		for(size_t step = 1; step < n; step *= 2) {
+			workers.clear();
+			for(size_t i = 0; i + step < n; i += 2 * step) {
+				size_t first = bounds[i];
+				size_t middle = bounds[i + step];
+				size_t last = bounds[std::min(i + 2 * step, n)];
+
+				workers.emplace_back([this, &v, first, middle, last]() {
+					std::inplace_merge(v.begin() + first, v.begin() + middle, v.begin() + last, comp);
+				});
+			}
+			for(auto& w : workers) w.join();
+		}
+	}
+
+	v.erase(std::unique(v.begin(), v.end(), [this](const T& a, const T& b) { return equal(a, b); }), v.end());
+}
+
+// LSD radix sort of integral values, one pass per byte
+// Each value is mapped to an unsigned key with the same order, i.e. the sign bit is flipped,
+// and all bits are flipped for std::greater. Passes where all keys have the same byte are skipped
+// Large vectors are split in chunks: each thread counts the bytes of its chunk,
+// then moves its values to the positions given by the prefix sums of all counts
+template <typename T, typename Compare, typename Allocator>
+void BasicSet<T, Compare, Allocator>::radix_sort(std::vector<T>& v) const {
+	using Key = typename std::make_unsigned<T>::type;
+	constexpr size_t buckets = 256;
+
+	auto key = [](const T& val) {
+		Key k = static_cast<Key>(val);
+		if(std::is_signed<T>::value) k ^= Key(1) << (8 * sizeof(T) - 1);
+		if(std::is_same<Compare, std::greater<T>>::value) k = static_cast<Key>(~k);
+		return k;
+	};
+
+	size_t n = (v.size() >= parallel_threshold) ? number_of_parts() : 1;
+
+	std::vector<size_t> bounds;
+	for(size_t i = 0; i <= n; ++i) {
+		bounds.push_back(v.size() * i / n);
+	}
+
+	// Call f(i) for each chunk i, in parallel if there are several chunks
+	auto for_each_chunk = [n](auto f) {
+		if(n == 1) {
+			f(0);
+			return;
+		}
+
+		std::vector<std::thread> workers;
+		for(size_t i = 0; i < n; ++i) {
+			workers.emplace_back(f, i);
+		}
+		for(auto& w : workers) w.join();
+	};
+
+	std::vector<T> buffer(v.size());
+	std::vector<size_t> counts(n * buckets);  // counts[i * buckets + b]: values with byte b in chunk i
+
+	for(size_t shift = 0; shift < 8 * sizeof(T); shift += 8) {
+		std::fill(counts.begin(), counts.end(), 0);
+
+		for_each_chunk([&](size_t i) {
+			size_t* c = &counts[i * buckets];
+			for(size_t j = bounds[i]; j < bounds[i + 1]; ++j) {
+				++c[(key(v[j]) >> shift) & (buckets - 1)];
+			}
+		});
+
+		// Prefix sums, ordered by byte and then by chunk
+		size_t sum = 0;
+		bool same_byte = false;
+		for(size_t b = 0; b < buckets; ++b) {
+			size_t first = sum;
+			for(size_t i = 0; i < n; ++i) {
+				size_t c = counts[i * buckets + b];
+				counts[i * buckets + b] = sum;
+				sum += c;
+			}
+			if(sum - first == v.size()) same_byte = true;
+		}
+		if(same_byte) continue;
+
+		for_each_chunk([&](size_t i) {
+			size_t* c = &counts[i * buckets];
+			for(size_t j = bounds[i]; j < bounds[i + 1]; ++j) {
+				buffer[c[(key(v[j]) >> shift) & (buckets - 1)]++] = v[j];
+			}
+		});
+
+		v.swap(buffer);
+	}
+}
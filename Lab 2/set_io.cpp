@@ -0,0 +1,468 @@
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cstring>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SET_IO_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "set_io.h"
+
+namespace {
+
+const char magic[4] = {'S', 'E', 'T', 'B'};
+const uint32_t version = 1;
+const size_t header_size = 32;
+const size_t index_entry_size = 16;
+const size_t write_buffer_size = 1 << 16;  // bytes buffered by write_set
+
+// States of the blocks of a MappedSet
+const unsigned char unchecked = 0;
+const unsigned char valid = 1;
+const unsigned char invalid = 2;
+
+// Append val to out, little-endian
+void put_u32(std::vector<unsigned char>& out, uint32_t val) {
+	for (int i = 0; i < 4; ++i) {
+		out.push_back(static_cast<unsigned char>(val >> (8 * i)));
+	}
+}
+
+void put_u64(std::vector<unsigned char>& out, uint64_t val) {
+	for (int i = 0; i < 8; ++i) {
+		out.push_back(static_cast<unsigned char>(val >> (8 * i)));
+	}
+}
+
+// Append val to out as a varint, 7 bits per byte, the high bit is set in all bytes but the last
+void put_varint(std::vector<unsigned char>& out, uint32_t val) {
+	while (val >= 0x80) {
+		out.push_back(static_cast<unsigned char>(val | 0x80));
+		val >>= 7;
+	}
+	out.push_back(static_cast<unsigned char>(val));
+}
+
+// Number of bytes of val as a varint
+size_t varint_size(uint32_t val) {
+	size_t n = 1;
+	for (; val >= 0x80; val >>= 7) {
+		++n;
+	}
+	return n;
+}
+
+// Varint stored for val after prev in a block
+// Values are increasing, so the difference is exact in unsigned arithmetic
+uint32_t gap(int prev, int val) {
+	return static_cast<uint32_t>(val) - static_cast<uint32_t>(prev) - 1;
+}
+
+// Write the bytes of out to os and empty out
+void flush(std::ostream& os, std::vector<unsigned char>& out) {
+	os.write(reinterpret_cast<const char*>(out.data()), static_cast<std::streamsize>(out.size()));
+	out.clear();
+}
+
+// Read a little-endian integer at p
+uint32_t get_u32(const unsigned char* p) {
+	uint32_t val = 0;
+	for (int i = 3; i >= 0; --i) {
+		val = (val << 8) | p[i];
+	}
+	return val;
+}
+
+uint64_t get_u64(const unsigned char* p) {
+	uint64_t val = 0;
+	for (int i = 7; i >= 0; --i) {
+		val = (val << 8) | p[i];
+	}
+	return val;
+}
+
+// Read a varint at p, without reading beyond end
+// Return the byte after it, or nullptr if the varint is truncated or too long
+const unsigned char* get_varint(const unsigned char* p, const unsigned char* end, uint32_t& val) {
+	val = 0;
+	for (int shift = 0; shift < 35 && p != end; shift += 7) {
+		unsigned char byte = *p++;
+		val |= static_cast<uint32_t>(byte & 0x7f) << shift;
+		if ((byte & 0x80) == 0) return p;
+	}
+	return nullptr;
+}
+
+}  // namespace
+
+/*****************************************************
+ * Serialization of a Set                             *
+ ******************************************************/
+
+// Write the header, the index and the encoded blocks
+// The size of the data goes in the header, so a first pass adds up the sizes of the varints
+bool write_set(std::ostream& os, const Set& S, uint32_t block_size) {
+	assert(block_size > 0);
+
+	uint64_t data_size = 0;
+	size_t i = 0;
+	int prev = 0;
+
+	for (int val : S) {
+		if (i % block_size != 0) data_size += varint_size(gap(prev, val));
+		prev = val;
+		++i;
+	}
+
+	std::vector<unsigned char> out(magic, magic + 4);
+	out.reserve(write_buffer_size + index_entry_size);
+
+	put_u32(out, version);
+	put_u64(out, S.cardinality());
+	put_u32(out, block_size);
+	put_u32(out, static_cast<uint32_t>((S.cardinality() + block_size - 1) / block_size));
+	put_u64(out, data_size);
+
+	// index, the offsets are the sizes of the varints before each block
+	uint64_t offset = 0;
+	i = 0;
+
+	for (int val : S) {
+		if (i % block_size == 0) {
+			put_u64(out, offset);
+			put_u32(out, static_cast<uint32_t>(val));
+			put_u32(out, 0);
+			if (out.size() >= write_buffer_size) flush(os, out);
+		} else {
+			offset += varint_size(gap(prev, val));
+		}
+		prev = val;
+		++i;
+	}
+
+	// blocks
+	i = 0;
+
+	for (int val : S) {
+		if (i % block_size != 0) {
+			put_varint(out, gap(prev, val));
+			if (out.size() >= write_buffer_size) flush(os, out);
+		}
+		prev = val;
+		++i;
+	}
+
+	flush(os, out);
+	return static_cast<bool>(os);
+}
+
+// Write S to a file
+bool save_set(const Set& S, const std::string& path) {
+	std::ofstream file{path, std::ios::binary | std::ios::trunc};
+
+	return file && write_set(file, S) && file.flush();
+}
+
+// Read a file through a MappedSet
+bool load_set(const std::string& path, Set& S) {
+	MappedSet M{path};
+
+	if (!M.is_open() || !M.validate()) return false;
+
+	S = M.to_set();
+	return true;
+}
+
+/*****************************************************
+ * Implementation of class MappedSet                  *
+ ******************************************************/
+
+// Default constructor
+MappedSet::MappedSet()
+	: bytes{nullptr}, size{0}, mapped{false}, counter{0}, block_size{1}, blocks{0},
+	  index{nullptr}, data{nullptr}, data_size{0} {
+}
+
+// Map a file
+MappedSet::MappedSet(const std::string& path)
+	: MappedSet{} {
+	open(path);
+}
+
+// Destructor
+MappedSet::~MappedSet() {
+	close();
+}
+
+// Map file path, or read it into the buffer
+bool MappedSet::open(const std::string& path) {
+	close();
+
+#ifdef SET_IO_MMAP
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+		::close(fd);
+		return false;
+	}
+
+	void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);  // the mapping stays valid
+
+	if (p == MAP_FAILED) return false;
+
+	bytes = static_cast<const unsigned char*>(p);
+	size = static_cast<size_t>(st.st_size);
+	mapped = true;
+#else
+	std::ifstream file{path, std::ios::binary};
+	if (!file) return false;
+
+	buffer.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+	bytes = buffer.data();
+	size = buffer.size();
+#endif
+
+	if (!parse()) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+// Unmap the file
+void MappedSet::close() {
+#ifdef SET_IO_MMAP
+	if (mapped) munmap(const_cast<unsigned char*>(bytes), size);
+#endif
+
+	buffer.clear();
+	buffer.shrink_to_fit();
+
+	bytes = nullptr;
+	size = 0;
+	mapped = false;
+	counter = 0;
+	block_size = 1;
+	blocks = 0;
+	index = nullptr;
+	data = nullptr;
+	data_size = 0;
+	checked.reset();
+}
+
+// Check the blocks, each one is decoded at most once
+bool MappedSet::validate() const {
+	bool ok = true;
+
+	for (size_t b = 0; b < blocks; ++b) {
+		ok = check_block(b) && ok;
+	}
+	return ok;
+}
+
+// Test whether a file is mapped
+bool MappedSet::is_open() const {
+	return bytes != nullptr;
+}
+
+// Test whether the set is empty
+bool MappedSet::is_empty() const {
+	return counter == 0;
+}
+
+// Return number of values
+size_t MappedSet::cardinality() const {
+	return counter;
+}
+
+// Return number of blocks
+size_t MappedSet::number_of_blocks() const {
+	return blocks;
+}
+
+// Test membership: find the last block starting at or before val, then decode it
+bool MappedSet::is_member(int val) const {
+	size_t lo = 0;
+	size_t hi = blocks;
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (first_value(mid) <= val) lo = mid + 1;
+		else hi = mid;
+	}
+
+	if (lo == 0) return false;  // val is smaller than all values
+
+	// the iterator leaves the block after its last value
+	Iterator it{this, lo - 1};
+
+	for (; it.block == lo - 1 && *it < val; ++it) {
+	}
+	return it.block == lo - 1 && *it == val;
+}
+
+// Convert to a Set, in one pass
+Set MappedSet::to_set() const {
+	return Set{MappedSetLeaf{*this}};
+}
+
+// Iterator to the smallest value
+MappedSet::Iterator MappedSet::begin() const {
+	return Iterator{this, 0};
+}
+
+// Iterator past the largest value
+MappedSet::Iterator MappedSet::end() const {
+	return Iterator{this, blocks};
+}
+
+// Ordering of the values
+MappedSet::key_compare MappedSet::key_comp() const {
+	return key_compare{};
+}
+
+// Check the header, and locate the index and the blocks
+bool MappedSet::parse() {
+	if (size < header_size || std::memcmp(bytes, magic, 4) != 0 || get_u32(bytes + 4) != version) return false;
+
+	uint64_t n = get_u64(bytes + 8);
+	uint64_t bsize = get_u32(bytes + 16);
+	uint64_t nblocks = get_u32(bytes + 20);
+	uint64_t dsize = get_u64(bytes + 24);
+
+	if (bsize == 0 || nblocks != (n + bsize - 1) / bsize) return false;
+	if (nblocks > (size - header_size) / index_entry_size) return false;
+	if (dsize != size - header_size - nblocks * index_entry_size) return false;
+
+	counter = static_cast<size_t>(n);
+	block_size = static_cast<size_t>(bsize);
+	blocks = static_cast<size_t>(nblocks);
+	index = bytes + header_size;
+	data = index + blocks * index_entry_size;
+	data_size = static_cast<size_t>(dsize);
+
+	checked.reset(new std::atomic<unsigned char>[blocks]());
+	return true;
+}
+
+// Test whether a block is valid, it is decoded the first time only
+// Threads checking the same block concurrently find the same state
+bool MappedSet::check_block(size_t block) const {
+	unsigned char state = checked[block].load(std::memory_order_relaxed);
+
+	if (state == unchecked) {
+		state = decode_block(block) ? valid : invalid;
+		checked[block].store(state, std::memory_order_relaxed);
+	}
+	return state == valid;
+}
+
+// A block must lie inside the data, before the next one, start above the first value of the previous one,
+// decode into its number of values, strictly increasing, end where the next one begins,
+// and stay below the first value of the next one
+bool MappedSet::decode_block(size_t block) const {
+	uint64_t offset = get_u64(index + block * index_entry_size);
+	uint64_t next = (block + 1 < blocks) ? get_u64(index + (block + 1) * index_entry_size) : data_size;
+
+	if (offset > next || next > data_size) return false;
+	if (block > 0 && first_value(block) <= first_value(block - 1)) return false;
+
+	const unsigned char* p = data + offset;
+	const unsigned char* end = data + next;
+	int64_t val = first_value(block);
+
+	for (size_t i = 1; i < values_in_block(block); ++i) {
+		uint32_t delta;
+		p = get_varint(p, end, delta);
+		if (p == nullptr) return false;
+
+		val += static_cast<int64_t>(delta) + 1;  // no wrap around, unlike the iterator
+		if (val > INT_MAX) return false;
+	}
+
+	if (p != end) return false;
+	return block + 1 == blocks || val < first_value(block + 1);
+}
+
+// First value of a block
+int MappedSet::first_value(size_t block) const {
+	return static_cast<int>(get_u32(index + block * index_entry_size + 8));
+}
+
+// First byte of the varints of a block
+const unsigned char* MappedSet::block_begin(size_t block) const {
+	return data + get_u64(index + block * index_entry_size);
+}
+
+// Byte after the varints of a block
+const unsigned char* MappedSet::block_end(size_t block) const {
+	return (block + 1 < blocks) ? block_begin(block + 1) : data + data_size;
+}
+
+// Number of values of a block
+size_t MappedSet::values_in_block(size_t block) const {
+	return (block + 1 < blocks) ? block_size : counter - block * block_size;
+}
+
+// Overloaded stream insertion operator<<
+std::ostream& operator<<(std::ostream& os, const MappedSet& M) {
+	if (M.is_empty()) {
+		os << "Set is empty!";
+	} else {
+		os << "{ ";
+		for (int val : M) {
+			os << val << " ";
+		}
+
+		os << "}";
+	}
+
+	return os;
+}
+
+/*****************************************************
+ * Implementation of class MappedSet::Iterator        *
+ ******************************************************/
+
+// Iterator to the first value of a block, or end() if block is the number of blocks or is not valid
+MappedSet::Iterator::Iterator(const MappedSet* M, size_t block)
+	: M{M}, block{block}, left{0}, ptr{nullptr}, end_ptr{nullptr}, val{0} {
+	if (block < M->blocks && M->check_block(block)) {
+		left = M->values_in_block(block) - 1;
+		ptr = M->block_begin(block);
+		end_ptr = M->block_end(block);
+		val = M->first_value(block);
+	} else {
+		this->block = M->blocks;
+	}
+}
+
+// Decode the next value, or move to the next block
+// The block was checked when the iterator entered it
+MappedSet::Iterator& MappedSet::Iterator::operator++() {
+	if (left == 0) {
+		*this = Iterator{M, block + 1};
+		return *this;
+	}
+
+	uint32_t delta;
+	ptr = get_varint(ptr, end_ptr, delta);
+
+	if (ptr == nullptr) {
+		*this = M->end();
+		return *this;
+	}
+
+	val = static_cast<int>(static_cast<uint32_t>(val) + delta + 1);
+	--left;
+	return *this;
+}
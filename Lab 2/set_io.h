@@ -0,0 +1,301 @@
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+#include <functional>
+#include <type_traits>
+
+#include "set.h"
+
+#pragma once
+
+/* ******************************************************************** *
+ * Binary file format of a Set of ints                                   *
+ *                                                                       *
+ * All integers are little-endian                                        *
+ *   header  32 bytes: "SETB", version (uint32, 1), number of values     *
+ *           (uint64), values per block (uint32), number of blocks       *
+ *           (uint32), size of the data in bytes (uint64)                *
+ *   index   16 bytes per block: offset of the block in the data         *
+ *           (uint64), first value of the block (int32), 0 (uint32)      *
+ *   data    for each block, the values after the first one as varints   *
+ *           of (value - previous value - 1), 7 bits per byte            *
+ *                                                                       *
+ * A dense Set takes about one byte per value, and a lookup decodes      *
+ * a single block after a binary search of the index                     *
+ * Blocks are checked when they are first decoded, so a file is opened   *
+ * in constant time                                                      *
+ * ******************************************************************** */
+
+/** Write Set S to os in the binary format
+ *
+ * \param block_size number of values per block
+ * S is walked three times, to size the data, then to write the index and the blocks,
+ * and the bytes are written through a buffer of fixed size, not held in memory
+ * Return false if the stream failed
+ *
+ */
+bool write_set(std::ostream& os, const Set& S, uint32_t block_size = 128);
+
+/** Write Set S to file path in the binary format, replacing it
+ *
+ * Return false if the file could not be written
+ *
+ */
+bool save_set(const Set& S, const std::string& path);
+
+/** Read the Set stored in file path into S
+ *
+ * Every block is checked, see MappedSet::validate()
+ * Return false, and S is not modified, if the file could not be read or is not a valid Set file
+ *
+ */
+bool load_set(const std::string& path, Set& S);
+
+/** Class to represent a read-only view of a Set file
+ *
+ * The file is mapped into memory (mmap) and decoded on demand, no Nodes are allocated
+ * Systems without mmap read the file into a buffer instead
+ * It supports is_member and iteration, and can be an operand of the
+ * Set expressions (set_expr.h), e.g. Set R = (M + S) - T; for a MappedSet M
+ *
+ * The file must not be modified while it is mapped
+ *
+ * Only the header is checked when the file is opened, each block is checked when it is first
+ * decoded: a block that is not valid ends an iteration, as if the Set ended before it,
+ * and its values are not members. validate() checks the whole file
+ */
+class MappedSet {
+public:
+	using value_type = int;
+	using key_compare = std::less<int>;
+
+	class Iterator;  // forward iterator decoding the blocks
+
+	using iterator = Iterator;
+	using const_iterator = Iterator;
+
+	// Default constructor: no file is mapped
+	MappedSet();
+
+	// Map file path, see is_open()
+	explicit MappedSet(const std::string& path);
+
+	// Unmap the file
+	~MappedSet();
+
+	// Copying is disallowed, the view owns the mapping
+	MappedSet(const MappedSet&) = delete;
+	MappedSet& operator=(const MappedSet&) = delete;
+
+	/** Map file path, after closing the current file
+	 *
+	 * O(1), the blocks are not decoded
+	 * Return false if the file could not be mapped or its header is not valid
+	 *
+	 */
+	bool open(const std::string& path);
+
+	/** Check every block not checked yet
+	 *
+	 * A truncated or corrupted varint, a block that does not end where the next one begins,
+	 * a wrong number of values or values that are not increasing make the file invalid
+	 * Return false if a file is mapped and is not a valid Set file
+	 *
+	 */
+	bool validate() const;
+
+	/** Unmap the file, the view becomes an empty Set
+	 *
+	 */
+	void close();
+
+	/** Return true, if a file is mapped
+	 *
+	 */
+	bool is_open() const;
+
+	/** Test whether the Set is empty
+	 *
+	 */
+	bool is_empty() const;
+
+	/** Count the number of values stored in the Set
+	 *
+	 */
+	size_t cardinality() const;
+
+	/** Count the number of blocks of the file
+	 *
+	 */
+	size_t number_of_blocks() const;
+
+	/** Test whether val belongs to the Set
+	 *
+	 * Binary search of the first values of the blocks, then the block of val is decoded
+	 *
+	 */
+	bool is_member(int val) const;
+
+	/** Return a Set with the same values
+	 *
+	 */
+	Set to_set() const;
+
+	/** Return an iterator to the smallest value
+	 *
+	 */
+	Iterator begin() const;
+
+	/** Return an iterator to the position after the largest value
+	 *
+	 */
+	Iterator end() const;
+
+	/** Return the ordering of the values
+	 *
+	 */
+	key_compare key_comp() const;
+
+private:
+	const unsigned char* bytes;  // contents of the file, nullptr if no file is mapped
+	size_t size;                 // size of the file in bytes
+	bool mapped;                 // true if bytes is a memory mapping, false if it points into buffer
+	std::vector<unsigned char> buffer;  // contents of the file on systems without mmap
+
+	size_t counter;     // number of values
+	size_t block_size;  // number of values per block, the last block may be shorter
+	size_t blocks;      // number of blocks
+	const unsigned char* index;  // first entry of the index
+	const unsigned char* data;   // first byte of the encoded blocks
+	size_t data_size;            // size of the encoded blocks in bytes
+
+	// state of each block: unchecked, valid or invalid
+	// Atomic, since blocks are checked by const member functions, possibly in different threads
+	std::unique_ptr<std::atomic<unsigned char>[]> checked;
+
+	bool parse();
+
+	bool check_block(size_t block) const;
+
+	bool decode_block(size_t block) const;
+
+	int first_value(size_t block) const;
+
+	const unsigned char* block_begin(size_t block) const;
+
+	const unsigned char* block_end(size_t block) const;
+
+	size_t values_in_block(size_t block) const;
+
+	// Overloaded operator<<, same format as for Set
+	friend std::ostream& operator<<(std::ostream& os, const MappedSet& M);
+};
+
+/* **********************************************************
+ * Forward iterator of a MappedSet                           *
+ * Values are decoded from the mapped blocks, in increasing  *
+ * order, and cannot be modified                             *
+ * ***********************************************************/
+
+class MappedSet::Iterator {
+public:
+	friend class MappedSet;
+
+	using iterator_category = std::forward_iterator_tag;
+	using value_type = int;
+	using difference_type = std::ptrdiff_t;
+	using pointer = const int*;
+	using reference = const int&;
+
+	Iterator() : M{nullptr}, block{0}, left{0}, ptr{nullptr}, end_ptr{nullptr}, val{0} {}
+
+	reference operator*() const {
+		return val;
+	}
+
+	pointer operator->() const {
+		return &val;
+	}
+
+	// Iterators are equal if they point to the same value, end() is past the last block
+	bool operator==(const Iterator& it) const {
+		return block == it.block && left == it.left;
+	}
+
+	bool operator!=(const Iterator& it) const {
+		return !(*this == it);
+	}
+
+	// Pre increment
+	Iterator& operator++();
+
+	// Post increment
+	Iterator operator++(int) {
+		Iterator old{*this};
+		++(*this);
+		return old;
+	}
+
+private:
+	const MappedSet* M;
+	size_t block;                // block of the current value, M->blocks for end()
+	size_t left;                 // values of the block after the current one
+	const unsigned char* ptr;    // next varint of the block
+	const unsigned char* end_ptr;  // end of the block
+	int val;                     // current value
+
+	Iterator(const MappedSet* M, size_t block);
+};
+
+/** Leaf of a Set expression walking a MappedSet, see set_expr.h
+ *
+ */
+class MappedSetLeaf : public SetExpr<MappedSetLeaf> {
+public:
+	using value_type = int;
+	using key_compare = std::less<int>;
+
+	explicit MappedSetLeaf(const MappedSet& M)
+		: it{M.begin()}, last{M.end()} {
+	}
+
+	bool done() const {
+		return it == last;
+	}
+
+	const int& value() const {
+		return *it;
+	}
+
+	void next() {
+		++it;
+	}
+
+	const key_compare& key_comp() const {
+		return comp;
+	}
+
+private:
+	MappedSet::Iterator it;
+	MappedSet::Iterator last;
+	key_compare comp;
+};
+
+// A MappedSet is an operand of the overloaded operators +, *, - and ^ of set_expr.h
+template <>
+struct is_set_like<MappedSet> : std::true_type {};
+
+template <typename Other>
+struct operand_expr<MappedSet, Other> {
+	using type = MappedSetLeaf;
+
+	template <typename O>
+	static type make(const MappedSet& M, const O&) {
+		return type{M};
+	}
+};
@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+#include "sketch.h"
+
+/* ******************************************** *
+ * Hash functions                               *
+ * ******************************************** */
+
+// i-th hash function of the MinHash signature
+static uint64_t hash(uint64_t h, int i) {
+	return mix_hash(h + (i + 1) * 0x9e3779b97f4a7c15ULL);
+}
+
+/*****************************************************
+ * Implementation of the member functions             *
+ ******************************************************/
+
+// Sketch of the empty set
+SetSketch::SetSketch()
+	: signature(num_hashes, std::numeric_limits<uint64_t>::max()), registers(1 << precision, 0) {
+}
+
+// Update the sketch with the key of a value
+void SetSketch::add_key(uint64_t key) {
+	uint64_t h = mix_hash(key);
+
+	for (int i = 0; i < num_hashes; ++i) {
+		signature[i] = std::min(signature[i], hash(h, i));
+	}
+
+	// The first bits select the register, the position of the first 1-bit in the rest is the rank
+	size_t index = h >> (64 - precision);
+	uint64_t rest = (h << precision) | (1ULL << (precision - 1));
+	uint8_t rank = 1;
+
+	while ((rest & (1ULL << 63)) == 0) {
+		rest <<= 1;
+		++rank;
+	}
+
+	registers[index] = std::max(registers[index], rank);
+}
+
+// Merge s into *this
+SetSketch& SetSketch::operator+=(const SetSketch& s) {
+	for (int i = 0; i < num_hashes; ++i) {
+		signature[i] = std::min(signature[i], s.signature[i]);
+	}
+
+	for (size_t j = 0; j < registers.size(); ++j) {
+		registers[j] = std::max(registers[j], s.registers[j]);
+	}
+
+	return *this;
+}
+
+// Estimated number of values
+double SetSketch::cardinality() const {
+	return estimate(registers);
+}
+
+// Estimated number of values in the union
+double SetSketch::union_cardinality(const SetSketch& s) const {
+	std::vector<uint8_t> merged(registers.size());
+
+	for (size_t j = 0; j < registers.size(); ++j) {
+		merged[j] = std::max(registers[j], s.registers[j]);
+	}
+
+	return estimate(merged);
+}
+
+// Estimated Jaccard similarity: fraction of equal signature entries
+double SetSketch::jaccard(const SetSketch& s) const {
+	const uint64_t empty = std::numeric_limits<uint64_t>::max();
+
+	if (signature[0] == empty && s.signature[0] == empty) return 1.0;
+
+	int equal = 0;
+	for (int i = 0; i < num_hashes; ++i) {
+		if (signature[i] == s.signature[i]) ++equal;
+	}
+
+	return static_cast<double>(equal) / num_hashes;
+}
+
+// One bucket key per band of the signature
+std::vector<uint64_t> SetSketch::lsh_keys(int bands) const {
+	assert(bands > 0 && num_hashes % bands == 0);
+
+	int rows = num_hashes / bands;
+	std::vector<uint64_t> keys;
+
+	for (int b = 0; b < bands; ++b) {
+		uint64_t key = mix_hash(b);
+
+		for (int i = b * rows; i < (b + 1) * rows; ++i) {
+			key = mix_hash(key ^ signature[i]);
+		}
+		keys.push_back(key);
+	}
+
+	return keys;
+}
+
+// HyperLogLog estimate, with linear counting for small cardinalities
+double SetSketch::estimate(const std::vector<uint8_t>& registers) {
+	double m = registers.size();
+	double sum = 0.0;
+	int zeros = 0;
+
+	for (uint8_t r : registers) {
+		sum += std::ldexp(1.0, -r);
+		if (r == 0) ++zeros;
+	}
+
+	double alpha = 0.7213 / (1.0 + 1.079 / m);
+	double E = alpha * m * m / sum;
+
+	if (E <= 2.5 * m && zeros > 0) {
+		E = m * std::log(m / zeros);
+	}
+
+	return E;
+}
+
+/* ******************************************** *
+ * LSH candidate pairs                          *
+ * ******************************************** */
+
+std::vector<std::pair<size_t, size_t>> lsh_candidates(const std::vector<SetSketch>& sketches, int bands) {
+	std::vector<std::pair<size_t, size_t>> pairs;
+	std::vector<std::vector<uint64_t>> keys;
+
+	for (const SetSketch& s : sketches) {
+		keys.push_back(s.lsh_keys(bands));
+	}
+
+	for (int b = 0; b < bands; ++b) {
+		std::unordered_map<uint64_t, std::vector<size_t>> buckets;
+
+		for (size_t i = 0; i < sketches.size(); ++i) {
+			buckets[keys[i][b]].push_back(i);
+		}
+
+		for (const auto& bucket : buckets) {
+			const std::vector<size_t>& ids = bucket.second;
+
+			for (size_t i = 0; i < ids.size(); ++i) {
+				for (size_t j = i + 1; j < ids.size(); ++j) {
+					pairs.emplace_back(ids[i], ids[j]);
+				}
+			}
+		}
+	}
+
+	std::sort(pairs.begin(), pairs.end());
+	pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+	return pairs;
+}
@@ -0,0 +1,101 @@
+#include <cstdint>
+#include <vector>
+#include <utility>
+
+#include "hash.h"
+
+#pragma once
+
+template <typename T, typename Compare, typename Allocator>
+class BasicSet;
+
+/** Class to represent approximate summaries (sketches) of a Set of integral values
+ *
+ * A sketch has a fixed size, independent of the number of values in the Set:
+ *  - a MinHash signature, the smallest hash of the values for each of num_hashes hash functions,
+ *    used to estimate the Jaccard similarity of two Sets
+ *  - HyperLogLog registers, used to estimate the cardinality of a Set and of unions of Sets
+ *
+ * Adding a value twice does not change a sketch, and the sketch of a union
+ * is obtained by merging the sketches of the operands
+ */
+class SetSketch {
+public:
+	static const int num_hashes = 128;  // length of the MinHash signature
+	static const int precision = 12;    // HyperLogLog uses 2^precision registers
+
+	/** Default constructor: create the sketch of an empty Set
+	 *
+	 */
+	SetSketch();
+
+	/** Create the sketch of all values in Set S
+	 *
+	 */
+	template <typename T, typename Compare, typename Allocator>
+	explicit SetSketch(const BasicSet<T, Compare, Allocator>& S)
+		: SetSketch{} {
+		for (T val : S) {
+			add(val);
+		}
+	}
+
+	/** Update the sketch with integral value val
+	 *
+	 */
+	template <typename T>
+	void add(T val) {
+		add_key(hash_key(val));
+	}
+
+	/** Merge sketch s into *this
+	 *
+	 * *this becomes the sketch of the union of both Sets
+	 *
+	 */
+	SetSketch& operator+=(const SetSketch& s);
+
+	/** Estimate the number of values in the Set
+	 *
+	 */
+	double cardinality() const;
+
+	/** Estimate the number of values in the union of the Sets of *this and s
+	 *
+	 */
+	double union_cardinality(const SetSketch& s) const;
+
+	/** Estimate the Jaccard similarity of the Sets of *this and s
+	 *
+	 * Standard error is about 1/sqrt(num_hashes)
+	 *
+	 */
+	double jaccard(const SetSketch& s) const;
+
+	/** Locality sensitive hashing of the MinHash signature
+	 *
+	 * The signature is split into bands of equal length and each band is hashed into a bucket key
+	 * Two Sets with Jaccard similarity J share at least one key with probability 1-(1-J^r)^bands,
+	 * where r = num_hashes/bands
+	 * \param bands number of bands, must divide num_hashes
+	 *
+	 */
+	std::vector<uint64_t> lsh_keys(int bands) const;
+
+private:
+	std::vector<uint64_t> signature;  // MinHash signature
+	std::vector<uint8_t> registers;   // HyperLogLog registers
+
+	void add_key(uint64_t key);
+
+	static double estimate(const std::vector<uint8_t>& registers);
+};
+
+/** Candidate pairs of similar Sets
+ *
+ * Return all pairs (i, j), i < j, of sketches sharing at least one LSH bucket key
+ * Only these pairs need to be compared, instead of all n*(n-1)/2 pairs
+ * \param bands number of bands, see SetSketch::lsh_keys
+ *
+ */
+std::vector<std::pair<size_t, size_t>> lsh_candidates(const std::vector<SetSketch>& sketches, int bands);
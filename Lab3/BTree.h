@@ -0,0 +1,765 @@
+#include <iostream>
+#include <iomanip> //setw
+#include <utility> //std::move, std::swap and std::pair
+#include <algorithm> //std::lower_bound, std::upper_bound and std::max
+#include <iterator> //std::bidirectional_iterator_tag
+#include <cstddef> //std::size_t and std::ptrdiff_t
+#include <cassert>
+
+#pragma once
+
+#include "dsexceptions.h"
+
+// BTree class
+//
+// B+ tree with the interface of BinarySearchTree.
+// All items are stored in the leaves, which are linked in increasing order.
+// The inner nodes store separators: child i holds the items smaller than keys[i],
+// and child i + 1 the items not smaller than keys[i].
+// A node holds up to Capacity items, about NodeBytes bytes, 4 cache lines by default,
+// so a tree of n items has about log(n) / log(Capacity / 2) levels instead of log2(n).
+//
+// CONSTRUCTION: zero parameter
+// Comparable must be default constructible, the nodes are arrays of Capacity items
+//
+// ******************PUBLIC OPERATIONS*********************
+// void insert( x )       --> Insert x
+// void remove( x )       --> Remove x
+// Iterator contains( x ) --> Return iterator to x, end( ) if not found
+// Comparable findMin( )  --> Return smallest item
+// Comparable findMax( )  --> Return largest item
+// boolean isEmpty( )     --> Return true if empty; else false
+// void makeEmpty( )      --> Remove all items
+// void printTree( )      --> Print the nodes in pre-order, one node per line
+// int height( )          --> Return number of levels of the tree
+// size_t size( )         --> Return number of items
+// find_pred_succ( x )    --> Return the closest items smaller and larger than x
+// get_parent( x )        --> Return the first separator of the node above the leaf of x
+// ******************ERRORS********************************
+// Throws UnderflowException as warranted
+
+template <typename Comparable, std::size_t NodeBytes = 256>
+class BTree
+{
+public:
+	// Maximum number of items of a node, at least 4
+	static constexpr int Capacity = static_cast<int>(std::max<std::size_t>(4, NodeBytes / sizeof(Comparable)));
+
+	class Iterator;
+
+	BTree() : root{nullptr}, levels{0}, counter{0} {}
+
+	/**
+	 * Copy constructor
+	 */
+	BTree(const BTree &rhs) : root{nullptr}, levels{rhs.levels}, counter{rhs.counter} {
+		Leaf *last = nullptr;
+		root = clone(rhs.root, rhs.levels, last);
+	}
+
+	/**
+	 * Destructor for the tree
+	 */
+	~BTree() {
+		makeEmpty();
+	}
+
+	/**
+	 * Copy assignment: copy and swap idiom
+	 */
+	BTree &operator=(BTree _copy) {
+		std::swap(root, _copy.root);
+		std::swap(levels, _copy.levels);
+		std::swap(counter, _copy.counter);
+		return *this;
+	}
+
+	/**
+	 * Returns the iterator pointing to the smallest item of the tree
+	 */
+	Iterator begin() const {
+		Leaf *l = firstLeaf();
+		return Iterator{this, l, 0};
+	}
+
+	/**
+	 * Returns the iterator past the largest item of the tree
+	 */
+	Iterator end() const {
+		return Iterator{this, nullptr, 0};
+	}
+
+	/**
+	 * Find the smallest item in the tree.
+	 * Throw UnderflowException if empty.
+	 */
+	const Comparable &findMin() const {
+		if (isEmpty()) {
+			throw UnderflowException{};
+		}
+
+		return firstLeaf()->keys[0];
+	}
+
+	/**
+	 * Find the largest item in the tree.
+	 * Throw UnderflowException if empty.
+	 */
+	const Comparable &findMax() const {
+		if (isEmpty()) {
+			throw UnderflowException{};
+		}
+
+		Leaf *l = lastLeaf();
+		return l->keys[l->count - 1];
+	}
+
+	/**
+	 * Return an iterator to x, end() if x is not found.
+	 */
+	Iterator contains(const Comparable &x) const {
+		if (isEmpty()) {
+			return end();
+		}
+
+		Leaf *l = findLeaf(x);
+		int i = lowerBound(l, x);
+
+		return (i < l->count && !(x < l->keys[i])) ? Iterator{this, l, i} : end();
+	}
+
+	/**
+	 * Test if the tree is logically empty.
+	 * Return true if empty, false otherwise.
+	 */
+	bool isEmpty() const {
+		return root == nullptr;
+	}
+
+	/**
+	 * Return the number of items.
+	 */
+	std::size_t size() const {
+		return counter;
+	}
+
+	/**
+	 * Return the number of levels of the tree, 0 if it is empty.
+	 */
+	int height() const {
+		return levels;
+	}
+
+	/**
+	 * Print the nodes of the tree in pre-order, indented by level.
+	 */
+	void printTree(std::ostream &out = std::cout) const {
+		if (isEmpty()) {
+			out << "Empty tree";
+		}
+		else {
+			preorder(root, levels, out);
+		}
+	}
+
+	/**
+	 * Make the tree logically empty.
+	 */
+	void makeEmpty() {
+		destroy(root, levels);
+		root = nullptr;
+		levels = 0;
+		counter = 0;
+	}
+
+	/**
+	 * Insert x into the tree; duplicates are ignored.
+	 * A full node is split in two halves, and the first item of the right half goes up to the parent.
+	 */
+	void insert(const Comparable &x) {
+		if (isEmpty()) {
+			Leaf *l = new Leaf{};
+			l->keys[0] = x;
+			l->count = 1;
+			root = l;
+			levels = 1;
+			counter = 1;
+			return;
+		}
+
+		Inner *path[max_levels];
+		int index[max_levels];
+		Leaf *l = descend(x, path, index);
+		int i = lowerBound(l, x);
+
+		if (i < l->count && !(x < l->keys[i])) {
+			return; // Duplicate; do nothing
+		}
+
+		++counter;
+		if (l->count < Capacity) {
+			insertAt(l->keys, l->count, i, x);
+			++l->count;
+			return;
+		}
+
+		// Split the leaf, the right half gets the larger items
+		Comparable all[Capacity + 1];
+		moveInto(all, l->keys, l->count, i, x);
+
+		Leaf *right = new Leaf{};
+		const int half = (Capacity + 1) / 2;
+
+		l->count = half;
+		right->count = Capacity + 1 - half;
+		std::move(all, all + half, l->keys);
+		std::move(all + half, all + Capacity + 1, right->keys);
+
+		right->next = l->next;
+		right->prev = l;
+		if (l->next != nullptr) {
+			l->next->prev = right;
+		}
+		l->next = right;
+
+		insertInParent(path, index, levels - 1, right->keys[0], right);
+	}
+
+	/**
+	 * Remove x from the tree. Nothing is done if x is not found.
+	 * A node left with fewer than Capacity / 2 items borrows an item from a sibling,
+	 * or is merged with it.
+	 */
+	void remove(const Comparable &x) {
+		if (isEmpty()) {
+			return;
+		}
+
+		Inner *path[max_levels];
+		int index[max_levels];
+		Leaf *l = descend(x, path, index);
+		int i = lowerBound(l, x);
+
+		if (i == l->count || x < l->keys[i]) {
+			return; // Not found
+		}
+
+		--counter;
+		std::move(l->keys + i + 1, l->keys + l->count, l->keys + i);
+		--l->count;
+
+		// The separators equal to x may stay, they still divide the items correctly
+		if (levels == 1) {
+			if (l->count == 0) {
+				delete l;
+				root = nullptr;
+				levels = 0;
+			}
+			return;
+		}
+
+		if (l->count < min_count) {
+			fixLeaf(l, path[levels - 2], index[levels - 2]);
+			fixInner(path, index, levels - 2);
+		}
+	}
+
+	/**
+	 * Return a pair with the largest item smaller than x and the smallest item larger than x.
+	 * x itself takes the place of an item that does not exist.
+	 * Throw UnderflowException if empty.
+	 */
+	std::pair<Comparable, Comparable> find_pred_succ(const Comparable &x) const {
+		if (isEmpty()) {
+			throw UnderflowException{};
+		}
+
+		Leaf *l = findLeaf(x);
+		Iterator it{this, l, lowerBound(l, x)};
+
+		if (it.pos == l->count) {
+			it = Iterator{this, l->next, 0};
+		}
+
+		Iterator pred = it;
+		Iterator succ = it;
+
+		if (succ != end() && !(x < *succ)) {
+			++succ;  // skip x
+		}
+
+		Comparable a = (pred != begin()) ? *--pred : x;
+		Comparable b = (succ != end()) ? *succ : x;
+
+		return std::pair<Comparable, Comparable>{a, b};
+	}
+
+	/**
+	 * Return the smallest separator of the node above the leaf storing x,
+	 * the nearest equivalent of a parent item in a B+ tree.
+	 * Return Comparable{} if x is not found or the root is a leaf.
+	 */
+	Comparable get_parent(const Comparable &x) const {
+		if (levels < 2 || contains(x) == end()) {
+			return Comparable{};
+		}
+
+		Inner *path[max_levels];
+		int index[max_levels];
+		descend(x, path, index);
+
+		return path[levels - 2]->keys[0];
+	}
+
+	/** Return total number of existing nodes
+	 *
+	 * Used for debug purposes
+	 */
+	static int get_count_nodes() {
+		return count_nodes;
+	}
+
+private:
+	struct Node {
+		Comparable keys[Capacity];
+		int count = 0; // number of items in keys
+
+		Node() {
+			++count_nodes;
+		}
+
+		Node(const Node &) = delete;
+		Node &operator=(const Node &) = delete;
+
+		~Node() {
+			--count_nodes;
+			assert(count_nodes >= 0);
+		}
+	};
+
+	// Leaves are linked in increasing order of the items
+	struct Leaf : Node {
+		Leaf *prev = nullptr;
+		Leaf *next = nullptr;
+	};
+
+	// An inner node with count separators has count + 1 children
+	struct Inner : Node {
+		Node *children[Capacity + 1];
+	};
+
+	// Nodes have at least min_count items, except the root
+	static constexpr int min_count = Capacity / 2;
+
+	// Bound of the number of levels: every inner node but the root has at least 3 children
+	static constexpr int max_levels = 64;
+
+	static int count_nodes; // total number of existing nodes -- to help to detect bugs in the code
+
+	Node *root;
+	int levels;          // number of levels, the leaves are all at the last one
+	std::size_t counter; // number of items
+
+	/**
+	 * Return the index of the first item of node t not smaller than x.
+	 */
+	static int lowerBound(const Node *t, const Comparable &x) {
+		return static_cast<int>(std::lower_bound(t->keys, t->keys + t->count, x) - t->keys);
+	}
+
+	/**
+	 * Return the index of the child of inner node t where x belongs.
+	 */
+	static int childIndex(const Inner *t, const Comparable &x) {
+		return static_cast<int>(std::upper_bound(t->keys, t->keys + t->count, x) - t->keys);
+	}
+
+	/**
+	 * Return the leaf where x belongs.
+	 */
+	Leaf *findLeaf(const Comparable &x) const {
+		Node *t = root;
+
+		for (int level = 1; level < levels; ++level) {
+			Inner *in = static_cast<Inner *>(t);
+			t = in->children[childIndex(in, x)];
+		}
+
+		return static_cast<Leaf *>(t);
+	}
+
+	/**
+	 * Return the leaf where x belongs.
+	 * path[d] is the inner node at depth d on the way, and index[d] the child taken.
+	 */
+	Leaf *descend(const Comparable &x, Inner **path, int *index) const {
+		Node *t = root;
+
+		for (int d = 0; d < levels - 1; ++d) {
+			Inner *in = static_cast<Inner *>(t);
+			path[d] = in;
+			index[d] = childIndex(in, x);
+			t = in->children[index[d]];
+		}
+
+		return static_cast<Leaf *>(t);
+	}
+
+	Leaf *firstLeaf() const {
+		Node *t = root;
+
+		for (int level = 1; level < levels; ++level) {
+			t = static_cast<Inner *>(t)->children[0];
+		}
+
+		return static_cast<Leaf *>(t);
+	}
+
+	Leaf *lastLeaf() const {
+		Node *t = root;
+
+		for (int level = 1; level < levels; ++level) {
+			Inner *in = static_cast<Inner *>(t);
+			t = in->children[in->count];
+		}
+
+		return static_cast<Leaf *>(t);
+	}
+
+	/**
+	 * Insert x at position i of the first n items of array a, which has room for it.
+	 */
+	template <typename T>
+	static void insertAt(T *a, int n, int i, const T &x) {
+		std::move_backward(a + i, a + n, a + n + 1);
+		a[i] = x;
+	}
+
+	/**
+	 * Move the n items of array a into array all, with x inserted at position i.
+	 */
+	template <typename T>
+	static void moveInto(T *all, T *a, int n, int i, const T &x) {
+		std::move(a, a + i, all);
+		all[i] = x;
+		std::move(a + i, a + n, all + i + 1);
+	}
+
+	/**
+	 * Insert separator key and its right child into the inner node at depth d of the path,
+	 * splitting full nodes up to the root. A new root is added when the root splits.
+	 */
+	void insertInParent(Inner **path, int *index, int d, Comparable key, Node *right) {
+		while (d > 0) {
+			Inner *p = path[d - 1];
+			int i = index[d - 1]; // the left half is child i, right becomes child i + 1
+
+			if (p->count < Capacity) {
+				insertAt(p->keys, p->count, i, key);
+				insertAt(p->children, p->count + 1, i + 1, right);
+				++p->count;
+				return;
+			}
+
+			Comparable keys[Capacity + 1];
+			Node *children[Capacity + 2];
+			moveInto(keys, p->keys, p->count, i, key);
+			moveInto(children, p->children, p->count + 1, i + 1, right);
+
+			// The middle separator goes up, between the two halves
+			Inner *q = new Inner{};
+			const int half = (Capacity + 1) / 2;
+
+			p->count = half;
+			q->count = Capacity - half;
+			std::move(keys, keys + half, p->keys);
+			std::copy(children, children + half + 1, p->children);
+			std::move(keys + half + 1, keys + Capacity + 1, q->keys);
+			std::copy(children + half + 1, children + Capacity + 2, q->children);
+
+			key = std::move(keys[half]);
+			right = q;
+			--d;
+		}
+
+		Inner *r = new Inner{};
+		r->count = 1;
+		r->keys[0] = std::move(key);
+		r->children[0] = root;
+		r->children[1] = right;
+		root = r;
+		++levels;
+	}
+
+	/**
+	 * Restore the minimum size of leaf l, child i of inner node p,
+	 * by borrowing an item from a sibling, or merging with a sibling.
+	 */
+	void fixLeaf(Leaf *l, Inner *p, int i) {
+		Leaf *left = (i > 0) ? static_cast<Leaf *>(p->children[i - 1]) : nullptr;
+		Leaf *right = (i < p->count) ? static_cast<Leaf *>(p->children[i + 1]) : nullptr;
+
+		if (left != nullptr && left->count > min_count) {
+			insertAt(l->keys, l->count, 0, left->keys[left->count - 1]);
+			++l->count;
+			--left->count;
+			p->keys[i - 1] = l->keys[0];
+		}
+		else if (right != nullptr && right->count > min_count) {
+			l->keys[l->count++] = std::move(right->keys[0]);
+			std::move(right->keys + 1, right->keys + right->count, right->keys);
+			--right->count;
+			p->keys[i] = right->keys[0];
+		}
+		else if (left != nullptr) {
+			mergeLeaves(left, l, p, i - 1);
+		}
+		else {
+			mergeLeaves(l, right, p, i);
+		}
+	}
+
+	/**
+	 * Move the items of leaf r into its left sibling l, and remove separator i and child i + 1 of p.
+	 */
+	void mergeLeaves(Leaf *l, Leaf *r, Inner *p, int i) {
+		std::move(r->keys, r->keys + r->count, l->keys + l->count);
+		l->count += r->count;
+
+		l->next = r->next;
+		if (r->next != nullptr) {
+			r->next->prev = l;
+		}
+		delete r;
+
+		removeFromInner(p, i);
+	}
+
+	/**
+	 * Remove separator i and child i + 1 of inner node p.
+	 */
+	static void removeFromInner(Inner *p, int i) {
+		std::move(p->keys + i + 1, p->keys + p->count, p->keys + i);
+		std::copy(p->children + i + 2, p->children + p->count + 1, p->children + i + 1);
+		--p->count;
+	}
+
+	/**
+	 * Restore the minimum size of the inner nodes on the path, from depth d up to the root.
+	 * The root is removed when it is left with one child.
+	 */
+	void fixInner(Inner **path, int *index, int d) {
+		for (; d > 0 && path[d]->count < min_count; --d) {
+			Inner *t = path[d];
+			Inner *p = path[d - 1];
+			int i = index[d - 1];
+
+			Inner *left = (i > 0) ? static_cast<Inner *>(p->children[i - 1]) : nullptr;
+			Inner *right = (i < p->count) ? static_cast<Inner *>(p->children[i + 1]) : nullptr;
+
+			if (left != nullptr && left->count > min_count) {
+				// Rotate right: the separator comes down, the last item of left goes up
+				insertAt(t->keys, t->count, 0, p->keys[i - 1]);
+				insertAt(t->children, t->count + 1, 0, left->children[left->count]);
+				++t->count;
+				p->keys[i - 1] = std::move(left->keys[left->count - 1]);
+				--left->count;
+			}
+			else if (right != nullptr && right->count > min_count) {
+				// Rotate left: the separator comes down, the first item of right goes up
+				t->keys[t->count] = std::move(p->keys[i]);
+				t->children[t->count + 1] = right->children[0];
+				++t->count;
+				p->keys[i] = std::move(right->keys[0]);
+				std::move(right->keys + 1, right->keys + right->count, right->keys);
+				std::copy(right->children + 1, right->children + right->count + 1, right->children);
+				--right->count;
+			}
+			else if (left != nullptr) {
+				mergeInner(left, t, p, i - 1);
+			}
+			else {
+				mergeInner(t, right, p, i);
+			}
+		}
+
+		if (d == 0 && path[0]->count == 0) {
+			root = path[0]->children[0];
+			delete path[0];
+			--levels;
+		}
+	}
+
+	/**
+	 * Move separator i of p and the items and children of inner node r into its left sibling l,
+	 * then remove separator i and child i + 1 of p.
+	 */
+	void mergeInner(Inner *l, Inner *r, Inner *p, int i) {
+		l->keys[l->count] = std::move(p->keys[i]);
+		std::move(r->keys, r->keys + r->count, l->keys + l->count + 1);
+		std::copy(r->children, r->children + r->count + 1, l->children + l->count + 1);
+		l->count += r->count + 1;
+		delete r;
+
+		removeFromInner(p, i);
+	}
+
+	/**
+	 * Delete subtree t with the given number of levels.
+	 */
+	void destroy(Node *t, int level) {
+		if (t == nullptr) {
+			return;
+		}
+
+		if (level == 1) {
+			delete static_cast<Leaf *>(t);
+			return;
+		}
+
+		Inner *in = static_cast<Inner *>(t);
+		for (int i = 0; i <= in->count; ++i) {
+			destroy(in->children[i], level - 1);
+		}
+		delete in;
+	}
+
+	/**
+	 * Copy subtree t with the given number of levels.
+	 * last is the last leaf copied so far, the copied leaves are linked to it in order.
+	 */
+	static Node *clone(Node *t, int level, Leaf *&last) {
+		if (t == nullptr) {
+			return nullptr;
+		}
+
+		if (level == 1) {
+			Leaf *l = new Leaf{};
+			std::copy(t->keys, t->keys + t->count, l->keys);
+			l->count = t->count;
+
+			l->prev = last;
+			if (last != nullptr) {
+				last->next = l;
+			}
+			last = l;
+			return l;
+		}
+
+		Inner *from = static_cast<Inner *>(t);
+		Inner *in = new Inner{};
+		std::copy(from->keys, from->keys + from->count, in->keys);
+		in->count = from->count;
+
+		for (int i = 0; i <= from->count; ++i) {
+			in->children[i] = clone(from->children[i], level - 1, last);
+		}
+		return in;
+	}
+
+	/**
+	 * Display subtree t in pre-order, one node per line.
+	 */
+	void preorder(Node *t, int level, std::ostream &out, int counter = 0) const {
+		out << std::setw(counter) << "" << '[';
+		for (int i = 0; i < t->count; ++i) {
+			out << (i > 0 ? " " : "") << t->keys[i];
+		}
+		out << "]\n";
+
+		if (level > 1) {
+			Inner *in = static_cast<Inner *>(t);
+			for (int i = 0; i <= in->count; ++i) {
+				preorder(in->children[i], level - 1, out, counter + 2);
+			}
+		}
+	}
+};
+
+// Initialize static data member -- counter of nodes
+template <typename Comparable, std::size_t NodeBytes>
+int BTree<Comparable, NodeBytes>::count_nodes = 0;
+
+/* **********************************************************
+ * Bi-directional iterator of a BTree                        *
+ * Items are visited in increasing order, along the linked   *
+ * leaves. Decrementing end() gives the largest item         *
+ * ***********************************************************/
+
+template <typename Comparable, std::size_t NodeBytes>
+class BTree<Comparable, NodeBytes>::Iterator {
+public:
+	friend class BTree<Comparable, NodeBytes>;
+
+	using iterator_category = std::bidirectional_iterator_tag;
+	using value_type = Comparable;
+	using difference_type = std::ptrdiff_t;
+	using pointer = Comparable*;
+	using reference = Comparable&;
+
+	Iterator() : tree{nullptr}, leaf{nullptr}, pos{0} {}
+
+	//return a reference to the element
+	Comparable& operator*() const {
+		return leaf->keys[pos];
+	}
+
+	//Return the adress of the element
+	Comparable* operator->() const {
+		return &leaf->keys[pos];
+	}
+
+	bool operator==(const Iterator& _it) const {
+		return leaf == _it.leaf && pos == _it.pos;
+	}
+
+	bool operator!=(const Iterator& _it) const {
+		return !(*this == _it);
+	}
+
+	//Pre increment
+	Iterator& operator++() {
+		if (++pos == leaf->count) {
+			leaf = leaf->next;
+			pos = 0;
+		}
+		return *this;
+	}
+
+	//Post increment
+	Iterator operator++(int) {
+		Iterator old{*this};
+		++(*this);
+		return old;
+	}
+
+	//Pre decrement
+	Iterator& operator--() {
+		if (leaf == nullptr) {
+			leaf = tree->lastLeaf();
+			pos = leaf->count - 1;
+		}
+		else if (pos > 0) {
+			--pos;
+		}
+		else {
+			leaf = leaf->prev;
+			pos = (leaf != nullptr) ? leaf->count - 1 : 0;
+		}
+		return *this;
+	}
+
+	//Post decrement
+	Iterator operator--(int) {
+		Iterator old{*this};
+		--(*this);
+		return old;
+	}
+
+private:
+	const BTree* tree;
+	Leaf* leaf; // nullptr for end()
+	int pos;    // index of the item in leaf
+
+	Iterator(const BTree* _tree, Leaf* _leaf, int _pos) : tree{_tree}, leaf{_leaf}, pos{_pos} {}
+};
@@ -1,6 +1,11 @@
 #include <iostream>
 #include <iomanip> //setw
-#include <utility> //std::move and std::pair
+#include <utility> //std::move, std::pair and std::in_place
+#include <algorithm> //std::max
+#include <type_traits> //std::is_same and std::conditional
+#include <vector>
+#include <thread>
+#include <iterator> //std::iterator_traits
 
 /**
  * Authors:
@@ -11,16 +16,33 @@
 #pragma once
 
 #include "dsexceptions.h"
+#include "SlabPool.h"
+#include "FrozenBST.h"
 // #include "iterator.h"
 
 using namespace std;
 
+// Balancing policies of BinarySearchTree
+//
+// Unbalanced: plain binary search tree, the shape depends on the order of insertion,
+//             e.g. sorted input degrades the tree to a linked list
+// AVLBalanced: AVL tree, the heights of the two subtrees of every node differ by at most one,
+//              so the height is at most 1.44 log2(n + 2)
+struct Unbalanced {};
+struct AVLBalanced {};
+
 // BinarySearchTree class
 //
-// CONSTRUCTION: zero parameter
+// CONSTRUCTION: zero parameter, or a range of items in any order (bulk load)
+// Balance: balancing policy, Unbalanced (default) or AVLBalanced
+// Alloc: node allocation policy, HeapNodes (default) or SlabNodes (see SlabPool.h)
 //
 // ******************PUBLIC OPERATIONS*********************
-// void insert( x )       --> Insert x
+// pair insert( x )       --> Insert x, return iterator to x and true if inserted
+// insert( hint, x )      --> Insert x next to hint, the position after x
+// emplace( args )        --> Insert the item constructed from args
+// try_emplace( key, args ) --> Insert Comparable(key, args), unless key is present
+// void insert( first, last ) --> Insert the items of a range (bulk merge)
 // void remove( x )       --> Remove x
 // bool contains( x )     --> Return true if x is present
 // Comparable findMin( )  --> Return smallest item
@@ -28,24 +50,59 @@ using namespace std;
 // boolean isEmpty( )     --> Return true if empty; else false
 // void makeEmpty( )      --> Remove all items
 // void printTree( )      --> Print tree in sorted order
+// int height( )          --> Return number of levels of the tree
+// size_t size( )         --> Return number of items
+// FrozenBST freeze( )    --> Return a read-only array snapshot for fast lookups
 // ******************ERRORS********************************
 // Throws UnderflowException as warranted
 
-template <typename Comparable>
+template <typename Comparable, typename Balance = Unbalanced, typename Alloc = HeapNodes>
 class BinarySearchTree
 {
 private:
 	struct Node; // nested class defined in node.h
 
+	// Enables the range members for input iterators only, so BinarySearchTree<int> t(3, 4) does not compile
+	template <typename It>
+	using RequireInputIterator = std::enable_if_t<std::is_base_of<std::input_iterator_tag,
+		typename std::iterator_traits<It>::iterator_category>::value>;
+
 public:
-	BinarySearchTree() : root{nullptr} {}
+	BinarySearchTree() : root{nullptr}, largest{nullptr}, counter{0} {}
 	class Iterator;
 
+	/**
+	 * Bulk constructor: the items of range [first, last), in any order; duplicates are ignored.
+	 * The items are sorted, in parallel for large ranges, then a perfectly balanced tree is built in O(n).
+	 * If copying an item throws, the nodes created so far are destroyed before the exception is rethrown.
+	 */
+	template <typename InputIt, typename = RequireInputIterator<InputIt>>
+	BinarySearchTree(InputIt first, InputIt last) : root{nullptr}, largest{nullptr}, counter{0} {
+		std::vector<Comparable> items(first, last);
+		sortUnique(items);
+
+		std::vector<Node *> nodes;
+		nodes.reserve(items.size());
+		try {
+			for (const Comparable &x : items) {
+				nodes.push_back(pool.create(x));
+			}
+		}
+		catch (...) {
+			for (Node *t : nodes) {
+				pool.destroy(t);
+			}
+			throw;
+		}
+
+		buildBalanced(nodes);
+	}
+
 	/**
 	 * Copy constructor
 	 */
-	BinarySearchTree(const BinarySearchTree &rhs) : root{nullptr} {
-		root = clone(rhs.root);
+	BinarySearchTree(const BinarySearchTree &rhs) : root{nullptr}, largest{nullptr}, counter{rhs.counter} {
+		root = clone(rhs.root, largest);
 	}
 
 	/**
@@ -60,6 +117,9 @@ public:
 	 */
 	BinarySearchTree &operator=(BinarySearchTree _copy) {
 		std::swap(root, _copy.root);
+		std::swap(largest, _copy.largest);
+		std::swap(counter, _copy.counter);
+		pool.swap(_copy.pool);
 		return *this;
 	}
 
@@ -68,14 +128,14 @@ public:
 	 */
 	Iterator begin() const {
 		if(isEmpty()) return end();
-		return Iterator (findMin(root));
+		return Iterator (findMin(root), this);
 	}
 
 	/**
 	 * Returns Iterator pointing to end of BST, i.e. successor of largest Comparable in the tree = nullptr
 	 */
 	Iterator end() const {
-		return Iterator {};
+		return Iterator {nullptr, this};
 	}
 
 	/**
@@ -99,14 +159,14 @@ public:
 			throw UnderflowException{};
 		}
 
-		return findMax(root)->element;
+		return largest->element;
 	}
 
 	/**
 	 * Returns true if x is found in the tree.
 	 */
 	Iterator contains(const Comparable &x) const {
-		return Iterator {contains(x, root)};
+		return Iterator {contains(x, root), this};
 	}
 
 	/**
@@ -132,23 +192,203 @@ public:
 
 	/**
 	 * Make the tree logically empty.
+	 * The SlabNodes policy releases all nodes at once when their elements need no destructor,
+	 * otherwise the nodes are destroyed one by one.
 	 */
 	void makeEmpty() {
-		root = makeEmpty(root);
+		if constexpr (slab && std::is_trivially_destructible<Comparable>::value) {
+			// ~Node only updates the counter of nodes
+			Node::count_nodes -= static_cast<int>(pool.size());
+			pool.clear();
+			root = nullptr;
+		}
+		else {
+			root = makeEmpty(root);
+			pool.clear();
+		}
+
+		largest = nullptr;
+		counter = 0;
 	}
 
 	/**
 	 * Insert x into the tree; duplicates are ignored.
+	 * Return an iterator to the item equivalent to x, and true if x was inserted.
 	 */
-	void insert(const Comparable &x) {
-		root = insert(x, root);
+	std::pair<Iterator, bool> insert(const Comparable &x) {
+		auto [t, inserted] = insertNode(x, x);
+		return {Iterator{t, this}, inserted};
+	}
+
+	/**
+	 * Insert x into the tree, moving it into the new node; duplicates are ignored.
+	 * Return an iterator to the item equivalent to x, and true if x was inserted.
+	 */
+	std::pair<Iterator, bool> insert(Comparable &&x) {
+		Node *p;
+		Node **link = findLink(x, p);
+
+		if (*link != nullptr) {
+			return {Iterator{*link, this}, false};
+		}
+
+		return {Iterator{linkNode(pool.create(std::in_place, std::move(x)), link, p), this}, true};
+	}
+
+	/**
+	 * Insert x with hint, an iterator to the position just after x.
+	 * A right hint inserts x next to it, without descending the tree: either as the left child of hint,
+	 * or else as the right child of its predecessor, the largest item of hint's left subtree.
+	 * Any other hint is ignored, and x is inserted from the root. Sorted input is inserted in O(1) amortized with hint end(),
+	 * whose predecessor is the largest node, kept by the tree.
+	 * Return an iterator to the item equivalent to x.
+	 */
+	Iterator insert(Iterator hint, const Comparable &x) {
+		Node *h = hint.node_ptr;
+		Node *before = (h != nullptr) ? h->prev : largest;
+
+		if ((before == nullptr || before->element < x) && (h == nullptr || x < h->element)) {
+			Node *t = pool.create(std::in_place, x);
+
+			if (h != nullptr && h->left == nullptr) {
+				return Iterator{linkNode(t, &h->left, h), this};
+			}
+			if (before != nullptr) {
+				return Iterator{linkNode(t, &before->right, before), this};
+			}
+			return Iterator{linkNode(t, &root, nullptr), this}; // empty tree
+		}
+
+		return insert(x).first;
+	}
+
+	/**
+	 * Construct an item from args in a new node, and insert it; duplicates are destroyed.
+	 * Return an iterator to the item equivalent to the new item, and true if it was inserted.
+	 */
+	template <typename... Args>
+	std::pair<Iterator, bool> emplace(Args &&...args) {
+		Node *t = pool.create(std::in_place, std::forward<Args>(args)...);
+		Node *p;
+		Node **link = findLink(t->element, p);
+
+		if (*link != nullptr) {
+			pool.destroy(t);
+			return {Iterator{*link, this}, false};
+		}
+
+		return {Iterator{linkNode(t, link, p), this}, true};
+	}
+
+	/**
+	 * Insert the item Comparable(key, args...), unless an item equivalent to key is present.
+	 * The item is only constructed when it is inserted, with one descent of the tree: e.g. for counting,
+	 * auto [it, inserted] = t.try_emplace(word); if (!inserted) ++*it;
+	 * Key is Comparable, or any type comparable with it in both orders.
+	 * Return an iterator to the item equivalent to key, and true if it was inserted.
+	 */
+	template <typename Key, typename... Args>
+	std::pair<Iterator, bool> try_emplace(const Key &key, Args &&...args) {
+		auto [t, inserted] = insertNode(key, key, std::forward<Args>(args)...);
+		return {Iterator{t, this}, inserted};
+	}
+
+	/**
+	 * Insert the items of range [first, last), in any order; duplicates are ignored.
+	 * A batch of k items that would cost more to insert one by one, k log2(n + k) steps,
+	 * than to rebuild the tree, n + k steps, is merged with the items of the tree,
+	 * and the tree is rebuilt perfectly balanced, reusing its nodes.
+	 * If copying an item throws, the new nodes are destroyed and the tree is not modified.
+	 */
+	template <typename InputIt, typename = RequireInputIterator<InputIt>>
+	void insert(InputIt first, InputIt last) {
+		std::vector<Comparable> items(first, last);
+		const std::size_t n = counter;
+		const std::size_t k = items.size();
+
+		if (k * log2Ceil(n + k) < n + k) {
+			for (const Comparable &x : items) {
+				insert(x);
+			}
+			return;
+		}
+
+		sortUnique(items);
+
+		// Merge the nodes of the tree, in sorted order, with new nodes for the items not in the tree
+		std::vector<Node *> nodes;
+		nodes.reserve(n + items.size());
+
+		Node *t = findMin(root);
+		try {
+			for (const Comparable &x : items) {
+				while (t != nullptr && t->element < x) {
+					nodes.push_back(t);
+					t = t->next;
+				}
+
+				if (t == nullptr || x < t->element) {
+					nodes.push_back(pool.create(x));
+				}
+			}
+		}
+		catch (...) {
+			// The tree is still linked: its nodes come in sorted order in nodes, the others are new
+			Node *old = findMin(root);
+			for (Node *u : nodes) {
+				if (u == old) {
+					old = old->next;
+				}
+				else {
+					pool.destroy(u);
+				}
+			}
+			throw;
+		}
+		for (; t != nullptr; t = t->next) {
+			nodes.push_back(t);
+		}
+
+		buildBalanced(nodes);
 	}
 
 	/**
 	 * Remove x from the tree. Nothing is done if x is not found.
 	 */
 	void remove(const Comparable &x) {
-		root = remove(x, root);
+		Node *t = contains(x, root);
+
+		if (t != nullptr) {
+			removeNode(t);
+		}
+	}
+
+	/**
+	 * Return the number of levels of the tree, 0 if it is empty.
+	 */
+	int height() const {
+		return computeHeight(root);
+	}
+
+	/**
+	 * Return the number of items.
+	 */
+	std::size_t size() const {
+		return counter;
+	}
+
+	/**
+	 * Return an immutable snapshot of the tree, laid out in an array for fast lookups (see FrozenBST.h).
+	 * Later changes of the tree do not affect the snapshot.
+	 */
+	FrozenBST<Comparable> freeze() const {
+		std::vector<Comparable> sorted;
+
+		for (Node *t = findMin(root); t != nullptr; t = t->next) {
+			sorted.push_back(t->element);
+		}
+
+		return FrozenBST<Comparable>{std::move(sorted)};
 	}
 
 	/** Return total number of existing nodes
@@ -226,96 +466,213 @@ public:
 	}
 
 private:
+	static constexpr bool slab = std::is_same<Alloc, SlabNodes>::value;
+
+	using Pool = typename std::conditional<slab, SlabPool<Node>, HeapPool<Node>>::type;
+
 	Node *root;
+	Node *largest; // node of the largest item, nullptr if the tree is empty
+	std::size_t counter; // number of items
+	Pool pool; // allocator of the nodes
 
-	/** 
-	 * Find the smallest element larger than t
-	 * Return the element 
+	// Ranges of at least this many items are sorted in parallel by the bulk operations
+	static const std::size_t parallel_sort_threshold = 1 << 16;
+
+	static constexpr bool avl = std::is_same<Balance, AVLBalanced>::value;
+	static const int ALLOWED_IMBALANCE = 1;
+
+	/**
+	 * Private member function to find the position of key, without recursion.
+	 * The tree is descended through the links to the children (pointers to the child pointers).
+	 * Return the link to the node storing an item equivalent to key, or else the empty link where key belongs;
+	 * p is set to the node holding the link, nullptr for root.
+	 * Key is Comparable, or any type comparable with it in both orders.
 	 */
-	static Node* find_successor(Node* t) {
-		//Return the node with smallest element on the right side of t ->
-		// the function returns nullptr if t->right is nullptr
-		if(t->right) return findMin(t->right);
+	template <typename Key>
+	Node **findLink(const Key &key, Node *&p) {
+		Node **link = &root;
+		p = nullptr;
+
+		while (*link != nullptr) {
+			Node *t = *link;
 
-		while(t->parent) {
-			if(t->element < t->parent->element) return t->parent;
-			t = t->parent;
+			if (key < t->element) {
+				link = &t->left;
+			}
+			else if (t->element < key) {
+				link = &t->right;
+			}
+			else {
+				break; // Match
+			}
+			p = t;
 		}
 
-		return nullptr;
+		return link;
 	}
-	/** 
-	 * Find the largest element smaller than t
-	 * Return the node 
+
+	/**
+	 * Private member function to add new node t at empty link of node p, found by findLink,
+	 * then the ancestors of t are rebalanced.
+	 * The new node is a leaf, so its neighbours in sorted order are its parent and the parent's old neighbour.
+	 * A new node without next neighbour is the largest one.
+	 * Return t.
 	 */
-	static Node* find_predecessor(Node* t) {
-		//Return the node with largest element on the left side of t ->
-		// the function returns nullptr if t->left is nullptr
-		if(!t) return findMax(root)
-		if(t->left) return findMax(t->left);
+	Node *linkNode(Node *t, Node **link, Node *p) {
+		*link = t;
+		t->parent = p;
+		++counter;
 
-		while(t->parent) {
-			if(t->element > t->parent->element) return t->parent;
-			t = t->parent;
+		if (p != nullptr) {
+			if (link == &p->left) {
+				t->next = p;
+				t->prev = p->prev;
+			}
+			else {
+				t->prev = p;
+				t->next = p->next;
+			}
+		}
+		linkNeighbours(t);
+		if (t->next == nullptr) {
+			largest = t;
 		}
 
-		return nullptr;
+		rebalance(p);
+		return t;
 	}
 
 	/**
-	 * Private member function to insert into a subtree.
-	 * x is the item to insert.
-	 * t is the node that roots the subtree.
-	 * p is the parent node (defaults to nullptr)
-	 * Return a pointer to the node storing x.
+	 * Private member function to insert an item made from args, unless an item equivalent to key is present.
+	 * The item is constructed in its node, only if it is inserted.
+	 * Return the node of the item equivalent to key, and true if it was inserted.
 	 */
-	Node *insert(const Comparable &x, Node *t, Node* p = nullptr) {
-		if (t == nullptr) {
-			t = new Node{x, nullptr, nullptr, p};
+	template <typename Key, typename... Args>
+	std::pair<Node *, bool> insertNode(const Key &key, Args &&...args) {
+		Node *p;
+		Node **link = findLink(key, p);
+
+		if (*link != nullptr) {
+			return {*link, false}; // Duplicate; do nothing
 		}
-		else if (x < t->element) {
-			t->left = insert(x, t->left, t);
+
+		return {linkNode(pool.create(std::in_place, std::forward<Args>(args)...), link, p), true};
+	}
+
+	/**
+	 * Private member function to remove node t from the tree, without recursion.
+	 * A node with two children is replaced by the node of its successor, the smallest item of its right subtree,
+	 * which has no left child; items are not moved, so iterators to the other items stay valid.
+	 * The removed node is unlinked from its neighbours in sorted order; if it was the largest node, its predecessor is now.
+	 * The nodes from the lowest changed subtree up are rebalanced.
+	 */
+	void removeNode(Node *t) {
+		Node *p; // lowest node whose subtree lost a node
+
+		if (t->left != nullptr && t->right != nullptr) { // Two children
+			Node *successor = t->next;
+
+			if (successor->parent == t) {
+				p = successor;
+			}
+			else { // The successor's right subtree takes its place, and it takes t's right subtree
+				p = successor->parent;
+				p->left = successor->right;
+				if (successor->right != nullptr) {
+					successor->right->parent = p;
+				}
+				successor->right = t->right;
+				t->right->parent = successor;
+			}
+
+			successor->left = t->left;
+			t->left->parent = successor;
+			successor->parent = t->parent;
+			successor->height = t->height;
+			childLink(t) = successor;
 		}
-		else if (t->element < x) {
-			t->right = insert(x, t->right, t);
+		else {
+			Node *child = (t->left != nullptr) ? t->left : t->right;
+			p = t->parent;
+
+			childLink(t) = child;
+			if (child != nullptr) {
+				child->parent = p;
+			}
+		}
+
+		if (t->prev != nullptr) {
+			t->prev->next = t->next;
+		}
+		if (t->next != nullptr) {
+			t->next->prev = t->prev;
 		}
 		else {
-			; // Duplicate; do nothing
+			largest = t->prev;
 		}
+		pool.destroy(t);
+		--counter;
 
-		return t;
+		rebalance(p);
 	}
 
 	/**
-	 * Private member function to remove from a subtree.
-	 * x is the item to remove.
-	 * t is the node that roots the subtree.
-	 * p is the parent node (defaults to nullptr) //TODO Not needed
-	 * Return a pointer to the new root of the subtree that had root x
+	 * Point the neighbours of node t in sorted order to t.
 	 */
-	Node *remove(const Comparable &x, Node *t) {
-		if (t == nullptr) {
-			return t; // Item not found
+	static void linkNeighbours(Node *t) {
+		if (t->prev != nullptr) {
+			t->prev->next = t;
 		}
-		
-		if (x < t->element) {
-			t->left = remove(x, t->left);
+		if (t->next != nullptr) {
+			t->next->prev = t;
 		}
-		else if (t->element < x) {
-			t->right = remove(x, t->right);
+	}
+
+	/**
+	 * Link node t after node last in sorted order, then t becomes the last node.
+	 */
+	static void appendNode(Node *t, Node *&last) {
+		t->prev = last;
+		if (last != nullptr) {
+			last->next = t;
 		}
-		else if (t->left != nullptr && t->right != nullptr) { // Two children
-			t->element = findMin(t->right)->element;
-			t->right = remove(t->element, t->right);
+		last = t;
+	}
+
+	/**
+	 * Return a reference to the pointer to node t, in its parent or root.
+	 */
+	Node *&childLink(Node *t) {
+		if (t->parent == nullptr) {
+			return root;
 		}
-		else {
-			Node *oldNode = t;
-			t = (t->left != nullptr) ? t->left : t->right;
-			t != nullptr ? t->parent = oldNode->parent : nullptr;
-			delete oldNode;
+
+		return (t->parent->left == t) ? t->parent->left : t->parent->right;
+	}
+
+	/**
+	 * Rebalance node t and its ancestors after an insertion or removal below t.
+	 * The walk up stops at the first node that is neither rotated nor changes height,
+	 * since the nodes above it are not affected.
+	 * Nothing is done by the Unbalanced policy.
+	 */
+	void rebalance(Node *t) {
+		if constexpr (!avl) {
+			return;
 		}
 
-		return t;
+		while (t != nullptr) {
+			Node *p = t->parent;
+			Node *&link = childLink(t);
+			int old_height = t->height;
+
+			link = balance(t);
+			if (link == t && t->height == old_height) {
+				break;
+			}
+
+			t = p;
+		}
 	}
 
 	/**
@@ -323,15 +680,13 @@ private:
 	 * Return node containing the smallest item.
 	 */
 	static Node *findMin(Node *t) {
-		if (t == nullptr) {
-			return nullptr;
-		}
-		if (t->left == nullptr) {
-			return t;
+		if (t != nullptr) {
+			while (t->left != nullptr) {
+				t = t->left;
+			}
 		}
 
-		// Tail recursion can be easily replaced by a loop
-		return findMin(t->left); // recursive call
+		return t;
 	}
 
 	/**
@@ -355,44 +710,40 @@ private:
 	 * Return a pointer to the node storing x, if x is found
 	 * Otherwise, return nullptr
 	 */
-	Node *contains(const Comparable &x, Node *t) const {
-		if (t == nullptr) {
-			return t;
-		}
-		else if (x < t->element) {
-			return contains(x, t->left);
-		}
-		else if (t->element < x) {
-			return contains(x, t->right);
-		}
-		else {
-			return t; // Match
-		}
-	}
-	/****** NONRECURSIVE VERSION*************************
 	Node *contains(const Comparable &x, Node *t) const {
 		while (t != nullptr) {
 			if (x < t->element) {
 				t = t->left;
-			} else if (t->element < x) {
+			}
+			else if (t->element < x) {
 				t = t->right;
-			} else {
-				return t;  // Match
+			}
+			else {
+				return t; // Match
 			}
 		}
 
-		return t;  // No match
+		return t; // No match
 	}
-	*****************************************************/
 
 	/**
-	 * Private member function to make subtree empty.
+	 * Private member function to make subtree empty, without recursion.
+	 * Left children are rotated up until the root has no left child, then the root is deleted
+	 * and its right child becomes the root. Every node is rotated at most once.
 	 */
 	Node *makeEmpty(Node *t) {
-		if (t != nullptr) {
-			makeEmpty(t->left);
-			makeEmpty(t->right);
-			delete t;
+		while (t != nullptr) {
+			if (t->left != nullptr) {
+				Node *l = t->left;
+				t->left = l->right;
+				l->right = t;
+				t = l;
+			}
+			else {
+				Node *r = t->right;
+				pool.destroy(t);
+				t = r;
+			}
 		}
 
 		return nullptr;
@@ -428,21 +779,289 @@ private:
 	}
 
 	/**
-	 * Private member function to clone subtree.
-	 * P is the parent
+	 * Private member function to compute the number of levels of subtree t.
+	 * The AVL policy stores it in the root, otherwise the nodes are visited with an explicit stack.
 	 */
-	Node *clone(Node *t, Node* p = nullptr) const {
+	static int computeHeight(Node *t) {
+		if (avl || t == nullptr) {
+			return height(t);
+		}
+
+		std::vector<std::pair<Node *, int>> stack{{t, 1}}; // nodes to visit and their levels
+		int levels = 0;
+
+		while (!stack.empty()) {
+			auto [n, level] = stack.back();
+			stack.pop_back();
+
+			levels = std::max(levels, level);
+			if (n->left != nullptr) stack.push_back({n->left, level + 1});
+			if (n->right != nullptr) stack.push_back({n->right, level + 1});
+		}
+
+		return levels;
+	}
+
+	/**
+	 * Return the height of node t, stored in the node by the AVL policy, or 0 for nullptr.
+	 */
+	static int height(Node *t) {
+		return t == nullptr ? 0 : t->height;
+	}
+
+	/**
+	 * Recompute the height of node t from the heights of its children.
+	 */
+	static void updateHeight(Node *t) {
+		t->height = 1 + std::max(height(t->left), height(t->right));
+	}
+
+	/**
+	 * Restore the AVL property of subtree t, whose children are balanced and differ in height by at most 2.
+	 * Nothing is done by the Unbalanced policy.
+	 * Return a pointer to the new root of the subtree, its parent is the parent of t.
+	 */
+	static Node *balance(Node *t) {
+		if constexpr (!avl) {
+			return t;
+		}
+
 		if (t == nullptr) {
+			return t;
+		}
+
+		if (height(t->left) - height(t->right) > ALLOWED_IMBALANCE) {
+			if (height(t->left->left) >= height(t->left->right)) {
+				t = rotateWithLeftChild(t);
+			}
+			else {
+				t = doubleWithLeftChild(t);
+			}
+		}
+		else if (height(t->right) - height(t->left) > ALLOWED_IMBALANCE) {
+			if (height(t->right->right) >= height(t->right->left)) {
+				t = rotateWithRightChild(t);
+			}
+			else {
+				t = doubleWithRightChild(t);
+			}
+		}
+
+		updateHeight(t);
+		return t;
+	}
+
+	/**
+	 * Rotate binary tree node k2 with its left child k1 (single rotation, case 1).
+	 * The parent pointers of k1, k2 and the subtree moved between them are updated.
+	 * Return k1, the new root of the subtree.
+	 */
+	static Node *rotateWithLeftChild(Node *k2) {
+		Node *k1 = k2->left;
+
+		k2->left = k1->right;
+		if (k2->left != nullptr) {
+			k2->left->parent = k2;
+		}
+
+		k1->right = k2;
+		k1->parent = k2->parent;
+		k2->parent = k1;
+
+		updateHeight(k2);
+		updateHeight(k1);
+		return k1;
+	}
+
+	/**
+	 * Rotate binary tree node k1 with its right child k2 (single rotation, case 4).
+	 * Return k2, the new root of the subtree.
+	 */
+	static Node *rotateWithRightChild(Node *k1) {
+		Node *k2 = k1->right;
+
+		k1->right = k2->left;
+		if (k1->right != nullptr) {
+			k1->right->parent = k1;
+		}
+
+		k2->left = k1;
+		k2->parent = k1->parent;
+		k1->parent = k2;
+
+		updateHeight(k1);
+		updateHeight(k2);
+		return k2;
+	}
+
+	/**
+	 * Double rotate binary tree node k3: first its left child with its right child,
+	 * then k3 with its new left child (case 2).
+	 * Return the new root of the subtree.
+	 */
+	static Node *doubleWithLeftChild(Node *k3) {
+		k3->left = rotateWithRightChild(k3->left);
+		return rotateWithLeftChild(k3);
+	}
+
+	/**
+	 * Double rotate binary tree node k1: first its right child with its left child,
+	 * then k1 with its new right child (case 3).
+	 * Return the new root of the subtree.
+	 */
+	static Node *doubleWithRightChild(Node *k1) {
+		k1->right = rotateWithLeftChild(k1->right);
+		return rotateWithRightChild(k1);
+	}
+
+	/**
+	 * Sort items, in parallel if there are many, and remove the duplicates.
+	 * Parallel sort: each thread sorts a part, then the sorted parts are merged pairwise.
+	 */
+	static void sortUnique(std::vector<Comparable> &items) {
+		const std::size_t n = items.size();
+		const std::size_t parts = std::min<std::size_t>(std::thread::hardware_concurrency(), 8);
+
+		if (n < parallel_sort_threshold || parts < 2) {
+			std::sort(items.begin(), items.end());
+		}
+		else {
+			const std::size_t part = (n + parts - 1) / parts;
+			std::vector<std::thread> threads;
+			threads.reserve(parts);
+
+			{
+				// Joins the started threads when leaving the scope, also if starting a thread throws
+				struct Joiner {
+					std::vector<std::thread> &threads;
+					~Joiner() {
+						for (auto &th : threads) {
+							th.join();
+						}
+					}
+				} joiner{threads};
+
+				for (std::size_t lo = 0; lo < n; lo += part) {
+					auto first = items.begin() + lo;
+					auto last = items.begin() + std::min(lo + part, n);
+					threads.emplace_back([first, last] { std::sort(first, last); });
+				}
+			}
+
+			for (std::size_t width = part; width < n; width *= 2) {
+				for (std::size_t lo = 0; lo + width < n; lo += 2 * width) {
+					std::inplace_merge(items.begin() + lo, items.begin() + lo + width,
+					                   items.begin() + std::min(lo + 2 * width, n));
+				}
+			}
+		}
+
+		// Sorted items are equal if the first is not smaller than the second
+		auto equal = [](const Comparable &a, const Comparable &b) { return !(a < b); };
+		items.erase(std::unique(items.begin(), items.end(), equal), items.end());
+	}
+
+	/**
+	 * Smallest number of bits to write n, at least 1.
+	 */
+	static std::size_t log2Ceil(std::size_t n) {
+		std::size_t bits = 1;
+
+		while (n >>= 1) {
+			++bits;
+		}
+
+		return bits;
+	}
+
+	/**
+	 * Link nodes, in sorted order, into a perfectly balanced tree, in O(n), and make it the tree.
+	 * The nodes of the tree must all be in nodes.
+	 */
+	void buildBalanced(std::vector<Node *> &nodes) {
+		Node *last = nullptr;
+
+		root = buildBalanced(nodes, 0, nodes.size(), nullptr, last);
+		if (last != nullptr) {
+			last->next = nullptr;
+		}
+		largest = last;
+		counter = nodes.size();
+	}
+
+	/**
+	 * Link nodes[lo, hi) into a perfectly balanced subtree with parent p: its root is the middle node.
+	 * last is the last node linked in sorted order.
+	 * Return the root of the subtree. The recursion depth is log2(n).
+	 */
+	static Node *buildBalanced(std::vector<Node *> &nodes, std::size_t lo, std::size_t hi, Node *p, Node *&last) {
+		if (lo == hi) {
 			return nullptr;
 		}
 
-		Node* temp = new Node{t->element};
-		
-		temp->left = clone(t->left, temp);
-		temp->right = clone(t->right, temp);
-		temp->parent = p;
+		std::size_t mid = lo + (hi - lo) / 2;
+		Node *t = nodes[mid];
+
+		t->parent = p;
+		t->left = buildBalanced(nodes, lo, mid, t, last);
+		appendNode(t, last);
+		t->right = buildBalanced(nodes, mid + 1, hi, t, last);
+		updateHeight(t);
+
+		return t;
+	}
+
+	/**
+	 * Private member function to clone subtree, without recursion.
+	 * The subtree is walked in pre-order with the parent pointers, and the copy is built along the walk:
+	 * a child is copied the first time the walk reaches it, and the walk goes up when both children are copied.
+	 * The root of the copy has no parent.
+	 * A copied node is linked after the previous one in sorted order once its left subtree is copied,
+	 * i.e. when the walk goes to its right child, or goes up from a node without right child.
+	 * last is set to the copy of the largest node of the subtree, nullptr if it is empty.
+	 */
+	Node *clone(Node *t, Node *&last) {
+		last = nullptr; // last copy linked in sorted order
+
+		if (t == nullptr) {
+			return nullptr;
+		}
+
+		Node *copy = pool.create(t->element);
+		copy->height = t->height;
+
+		Node *from = t;
+		Node *to = copy;
+
+		while (true) {
+			if (from->left != nullptr && to->left == nullptr) {
+				to->left = pool.create(from->left->element, nullptr, nullptr, to);
+				from = from->left;
+				to = to->left;
+			}
+			else if (from->right != nullptr && to->right == nullptr) {
+				appendNode(to, last);
+				to->right = pool.create(from->right->element, nullptr, nullptr, to);
+				from = from->right;
+				to = to->right;
+			}
+			else {
+				if (from->right == nullptr) {
+					appendNode(to, last);
+				}
+				if (from == t) {
+					break;
+				}
+
+				from = from->parent;
+				to = to->parent;
+				continue;
+			}
+
+			to->height = from->height;
+		}
 
-		return temp;
+		return copy;
 	}
 };
 
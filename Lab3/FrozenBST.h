@@ -0,0 +1,322 @@
+#include <cstddef> //std::size_t and std::ptrdiff_t
+#include <iterator> //std::bidirectional_iterator_tag
+#include <utility> //std::move
+#include <vector>
+
+#pragma once
+
+#include "dsexceptions.h"
+
+// FrozenBST class
+//
+// Immutable snapshot of a BinarySearchTree, see BinarySearchTree::freeze( )
+//
+// The items are stored in one array in Eytzinger (breadth-first) order:
+// the root is at position 1 and the children of position k are at 2k and 2k + 1.
+// A search descends with k = 2k + (a[k] < x), with no branch to mispredict,
+// and the nodes of the next levels are prefetched, since they are next to each other.
+//
+// CONSTRUCTION: with a vector of items in increasing order, no duplicates
+//
+// ******************PUBLIC OPERATIONS*********************
+// Iterator contains( x )    --> Return iterator to x, end( ) if not found
+// Iterator lower_bound( x ) --> Return iterator to the smallest item not less than x
+// Comparable findMin( )     --> Return smallest item
+// Comparable findMax( )     --> Return largest item
+// boolean isEmpty( )        --> Return true if empty; else false
+// size_t size( )            --> Return number of items
+// begin( ), end( )          --> In-order bidirectional iterators
+// ******************ERRORS********************************
+// Throws UnderflowException as warranted
+
+template <typename Comparable>
+class FrozenBST
+{
+public:
+	class Iterator;
+
+	FrozenBST() = default;
+
+	/**
+	 * Construct from items sorted in increasing order, without duplicates.
+	 */
+	explicit FrozenBST(std::vector<Comparable> sorted) {
+		const std::size_t n = sorted.size();
+
+		// rank[k] is the position in sorted order of the item at Eytzinger position k
+		std::vector<std::size_t> rank(n + 1);
+		std::size_t i = 0;
+
+		for (std::size_t k = first(n); k != 0; k = next(k, n)) {
+			rank[k] = i++;
+		}
+
+		items.reserve(n);
+		for (std::size_t k = 1; k <= n; ++k) {
+			items.push_back(std::move(sorted[rank[k]]));
+		}
+	}
+
+	/**
+	 * Returns the iterator pointing to the smallest item.
+	 */
+	Iterator begin() const {
+		return Iterator{this, first(size())};
+	}
+
+	/**
+	 * Returns the iterator past the largest item.
+	 */
+	Iterator end() const {
+		return Iterator{this, 0};
+	}
+
+	/**
+	 * Return an iterator to the smallest item not less than x, end() if there is none.
+	 */
+	Iterator lower_bound(const Comparable &x) const {
+		const std::size_t n = size();
+		std::size_t k = 1;
+
+		while (k <= n) {
+			prefetch(k * prefetch_distance);
+			k = 2 * k + static_cast<std::size_t>(at(k) < x);
+		}
+
+		// The descent went right after the last item not less than x, and then left all the way down:
+		// undo the trailing right moves and the last left move
+		k >>= trailingOnes(k) + 1;
+		return Iterator{this, k};
+	}
+
+	/**
+	 * Return an iterator to x, end() if x is not found.
+	 */
+	Iterator contains(const Comparable &x) const {
+		Iterator it = lower_bound(x);
+
+		return (it != end() && !(x < *it)) ? it : end();
+	}
+
+	/**
+	 * Find the smallest item.
+	 * Throw UnderflowException if empty.
+	 */
+	const Comparable &findMin() const {
+		if (isEmpty()) {
+			throw UnderflowException{};
+		}
+
+		return at(first(size()));
+	}
+
+	/**
+	 * Find the largest item.
+	 * Throw UnderflowException if empty.
+	 */
+	const Comparable &findMax() const {
+		if (isEmpty()) {
+			throw UnderflowException{};
+		}
+
+		return at(last(size()));
+	}
+
+	/**
+	 * Test if the snapshot is empty.
+	 */
+	bool isEmpty() const {
+		return items.empty();
+	}
+
+	/**
+	 * Return the number of items.
+	 */
+	std::size_t size() const {
+		return items.size();
+	}
+
+private:
+	std::vector<Comparable> items; // item of Eytzinger position k at index k - 1
+
+	// 16 positions ahead: the great-grandchildren of a node of 4-byte items share a cache line
+	static const std::size_t prefetch_distance = 16;
+
+	const Comparable &at(std::size_t k) const {
+		return items[k - 1];
+	}
+
+	void prefetch(std::size_t k) const {
+#if defined(__GNUC__)
+		if (k <= size()) {
+			__builtin_prefetch(&items[k - 1]);
+		}
+#else
+		(void)k;
+#endif
+	}
+
+	/**
+	 * Number of consecutive one bits of k, starting from the lowest bit.
+	 */
+	static int trailingOnes(std::size_t k) {
+#if defined(__GNUC__)
+		return __builtin_ctzll(~static_cast<unsigned long long>(k));
+#else
+		int ones = 0;
+		while (k & 1) {
+			k >>= 1;
+			++ones;
+		}
+		return ones;
+#endif
+	}
+
+	/**
+	 * Position of the smallest item of n items, 0 if n is 0.
+	 */
+	static std::size_t first(std::size_t n) {
+		if (n == 0) {
+			return 0;
+		}
+
+		std::size_t k = 1;
+		while (2 * k <= n) {
+			k = 2 * k;
+		}
+
+		return k;
+	}
+
+	/**
+	 * Position of the largest item of n items, 0 if n is 0.
+	 */
+	static std::size_t last(std::size_t n) {
+		if (n == 0) {
+			return 0;
+		}
+
+		std::size_t k = 1;
+		while (2 * k + 1 <= n) {
+			k = 2 * k + 1;
+		}
+
+		return k;
+	}
+
+	/**
+	 * In-order successor of position k among n items, 0 after the largest item.
+	 * The leftmost position of the right subtree, or else the first ancestor reached from its left subtree.
+	 */
+	static std::size_t next(std::size_t k, std::size_t n) {
+		if (2 * k + 1 <= n) {
+			k = 2 * k + 1;
+			while (2 * k <= n) {
+				k = 2 * k;
+			}
+
+			return k;
+		}
+
+		while (k & 1) {
+			k >>= 1;
+		}
+
+		return k >> 1;
+	}
+
+	/**
+	 * In-order predecessor of position k among n items, 0 before the smallest item.
+	 * The predecessor of 0, end(), is the largest item.
+	 */
+	static std::size_t prev(std::size_t k, std::size_t n) {
+		if (k == 0) {
+			return last(n);
+		}
+
+		if (2 * k <= n) {
+			k = 2 * k;
+			while (2 * k + 1 <= n) {
+				k = 2 * k + 1;
+			}
+
+			return k;
+		}
+
+		while (k != 0 && (k & 1) == 0) {
+			k >>= 1;
+		}
+
+		return k >> 1;
+	}
+};
+
+/* **********************************************************
+ * Bi-directional iterator of a FrozenBST                    *
+ * Items are visited in increasing order and cannot be       *
+ * modified. Decrementing end() gives the largest item       *
+ * ***********************************************************/
+
+template <typename Comparable>
+class FrozenBST<Comparable>::Iterator {
+public:
+	friend class FrozenBST<Comparable>;
+
+	using iterator_category = std::bidirectional_iterator_tag;
+	using value_type = Comparable;
+	using difference_type = std::ptrdiff_t;
+	using pointer = const Comparable*;
+	using reference = const Comparable&;
+
+	Iterator() : tree{nullptr}, pos{0} {}
+
+	//return a reference to the item
+	const Comparable& operator*() const {
+		return tree->at(pos);
+	}
+
+	//Return the adress of the item
+	const Comparable* operator->() const {
+		return &tree->at(pos);
+	}
+
+	bool operator==(const Iterator& _it) const {
+		return pos == _it.pos;
+	}
+
+	bool operator!=(const Iterator& _it) const {
+		return !(*this == _it);
+	}
+
+	//Pre increment
+	Iterator& operator++() {
+		pos = FrozenBST::next(pos, tree->size());
+		return *this;
+	}
+
+	//Post increment
+	Iterator operator++(int) {
+		Iterator old{*this};
+		++(*this);
+		return old;
+	}
+
+	//Pre decrement
+	Iterator& operator--() {
+		pos = FrozenBST::prev(pos, tree->size());
+		return *this;
+	}
+
+	//Post decrement
+	Iterator operator--(int) {
+		Iterator old{*this};
+		--(*this);
+		return old;
+	}
+
+private:
+	const FrozenBST* tree;
+	std::size_t pos; // Eytzinger position of the item, 0 for end()
+
+	Iterator(const FrozenBST* _tree, std::size_t _pos) : tree{_tree}, pos{_pos} {}
+};
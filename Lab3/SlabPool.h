@@ -0,0 +1,174 @@
+#include <cstddef> //std::size_t
+#include <memory> //std::unique_ptr
+#include <new> //placement new
+#include <utility> //std::forward and std::swap
+#include <vector>
+
+#pragma once
+
+// Node allocation policies of BinarySearchTree
+//
+// HeapNodes: every node is a separate new/delete
+// SlabNodes: nodes are carved from slabs of contiguous nodes, see SlabPool
+struct HeapNodes {};
+struct SlabNodes {};
+
+// HeapPool class
+//
+// Allocates objects of type T with new and delete, the default of BinarySearchTree
+//
+// ******************PUBLIC OPERATIONS*********************
+// T* create( args )      --> Construct a T from args
+// void destroy( p )      --> Destroy the object p
+// void clear( )          --> Nothing, every object must have been destroyed
+// void swap( other )     --> Nothing, the heap is shared
+
+template <typename T>
+class HeapPool
+{
+public:
+	template <typename... Args>
+	T *create(Args &&...args) {
+		return new T{std::forward<Args>(args)...};
+	}
+
+	void destroy(T *p) {
+		delete p;
+	}
+
+	void clear() {}
+
+	void swap(HeapPool &) {}
+};
+
+// SlabPool class
+//
+// Allocates objects of type T from slabs of SlabSize objects.
+// Slots of destroyed objects are kept in a free list and reused first,
+// otherwise the next unused slot of the current slab is taken.
+// Objects created one after the other are next to each other in memory,
+// and all of the memory is released at once, one delete per slab.
+//
+// ******************PUBLIC OPERATIONS*********************
+// T* create( args )      --> Construct a T from args in a free slot
+// void destroy( p )      --> Destroy the object p and free its slot
+// void clear( )          --> Free all slots, the objects must have been destroyed
+//                            or be trivially destructible; the slabs are kept for reuse
+// void swap( other )     --> Exchange the slabs of two pools
+// size_t size( )         --> Return number of objects
+
+template <typename T, std::size_t SlabSize = 256>
+class SlabPool
+{
+public:
+	SlabPool() = default;
+
+	// Copying is disallowed, objects must stay in their pool
+	SlabPool(const SlabPool &) = delete;
+	SlabPool &operator=(const SlabPool &) = delete;
+
+	/**
+	 * Destructor: release the slabs, the objects must have been destroyed
+	 */
+	~SlabPool() = default;
+
+	/**
+	 * Construct a T from args in a free slot.
+	 * If the constructor of T throws, the slot is freed.
+	 * Return a pointer to the new object.
+	 */
+	template <typename... Args>
+	T *create(Args &&...args) {
+		Slot *s = freeList;
+
+		if (s != nullptr) {
+			freeList = s->next;
+		}
+		else {
+			if (used == SlabSize) {
+				nextSlab();
+			}
+			s = &slabs[current][used++];
+		}
+
+		T *p;
+		try {
+			p = new (s->storage) T{std::forward<Args>(args)...};
+		}
+		catch (...) {
+			s->next = freeList;
+			freeList = s;
+			throw;
+		}
+
+		++live;
+		return p;
+	}
+
+	/**
+	 * Destroy object p, created by this pool, and put its slot in the free list.
+	 */
+	void destroy(T *p) {
+		p->~T();
+
+		Slot *s = reinterpret_cast<Slot *>(p);
+		s->next = freeList;
+		freeList = s;
+		--live;
+	}
+
+	/**
+	 * Make all slots free, without destroying the objects, in O(slabs).
+	 * The slabs are kept, and reused from the first one.
+	 */
+	void clear() {
+		freeList = nullptr;
+		current = 0;
+		used = slabs.empty() ? SlabSize : 0;
+		live = 0;
+	}
+
+	/**
+	 * Exchange the slabs of two pools, the objects keep their addresses.
+	 */
+	void swap(SlabPool &other) {
+		std::swap(slabs, other.slabs);
+		std::swap(freeList, other.freeList);
+		std::swap(current, other.current);
+		std::swap(used, other.used);
+		std::swap(live, other.live);
+	}
+
+	/**
+	 * Return the number of objects of the pool.
+	 */
+	std::size_t size() const {
+		return live;
+	}
+
+private:
+	// Storage of one object, or link to the next free slot
+	union Slot {
+		Slot *next;
+		alignas(T) unsigned char storage[sizeof(T)];
+	};
+
+	std::vector<std::unique_ptr<Slot[]>> slabs;
+	Slot *freeList = nullptr;    // slots of destroyed objects
+	std::size_t current = 0;     // index of the slab in use
+	std::size_t used = SlabSize; // slots of the current slab taken, SlabSize if there is no slab
+	std::size_t live = 0;        // number of objects
+
+	/**
+	 * Move to the next slab, allocated if all slabs were used.
+	 */
+	void nextSlab() {
+		if (!slabs.empty()) {
+			++current;
+		}
+		if (current == slabs.size()) {
+			slabs.emplace_back(new Slot[SlabSize]);
+		}
+		used = 0;
+	}
+};
@@ -33,6 +33,15 @@ public:
 	bool operator<(const FrequencyPair& rhs) const {
 		return (element < rhs.element);
 	}
+
+	// Compare with an element, to look up a pair without constructing one
+	friend bool operator<(const FrequencyPair& fp, const Comparable& c) {
+		return fp.element < c;
+	}
+
+	friend bool operator<(const Comparable& c, const FrequencyPair& fp) {
+		return c < fp.element;
+	}
 	
 	void operator++() { ++counter; }
 
@@ -73,11 +82,9 @@ int main() {
 		word.erase(std::remove_if(word.begin(), word.end(), isPunctation), word.end());
 		std::transform(word.begin(), word.end(), word.begin(), ::tolower);
 		
-		FrequencyPair fp{word};
-		auto it = BST.contains(fp);
-
-		if(it != BST.end()) ++*it;
-		else BST.insert(fp);
+		// One descent of the tree, a pair is only constructed for a new word
+		auto [it, inserted] = BST.try_emplace(word);
+		if(!inserted) ++*it;
 	}
 
 	std::cout << "\nNumber of words in the file: " << V.size() << "\n";
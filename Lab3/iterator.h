@@ -14,11 +14,11 @@
  * increasing and decreasing order of items keys             *
  * ***********************************************************/
 
-template <typename Comparable>
-class BinarySearchTree<Comparable>::Iterator {
+template <typename Comparable, typename Balance, typename Alloc>
+class BinarySearchTree<Comparable, Balance, Alloc>::Iterator {
 public:
-	friend class BinarySearchTree<Comparable>;
-	Iterator() : node_ptr{nullptr} {}
+	friend class BinarySearchTree<Comparable, Balance, Alloc>;
+	Iterator() : node_ptr{nullptr}, tree{nullptr} {}
 	~Iterator() = default;
 
 	//return a reference to the element
@@ -32,8 +32,7 @@ public:
 	}
 
 	bool operator==(const Iterator& _it) const {
-		return operator->() == _it.operator->();
-		// return node_ptr == _it.node_ptr;
+		return node_ptr == _it.node_ptr;
 	}
 
 	bool operator!=(const Iterator& _it) const {
@@ -42,35 +41,34 @@ public:
 	//Post Increment
 	Iterator operator++(int) {
 		//return copy of *this
-		const Iterator* old{*this};
+		Iterator old{*this};
 		++(*this);
 		return old;
 	}
 
-	//Pre increment
+	//Pre increment: follow the link to the next node in sorted order
 	Iterator& operator++() {
-		node_ptr = find_successor(node_ptr);
-		// node_ptr = find_successor(node_ptr);
+		node_ptr = node_ptr->next;
 		return *this;
 	}
 	
 	//Post decrement
 	Iterator operator--(int) {
 		//return copy of *this
-		const Iterator* old{*this};
+		Iterator old{*this};
 		--(*this);
 		return old;
 	}
 
-	//Pre decrement
+	//Pre decrement: follow the link to the previous node, end() moves to the largest item
 	Iterator& operator--() {
-		node_ptr = BinarySearchTree<Comparable>::find_predecessor(node_ptr);
-		// node_ptr = find_predecessor(node_ptr);
+		node_ptr = (node_ptr != nullptr) ? node_ptr->prev : tree->largest;
 		return *this;
 	}
 
 private:
 	Node* node_ptr;
+	const BinarySearchTree* tree; // tree of the node, to decrement end()
 
-	Iterator(Node* _ptr) : node_ptr{_ptr} {};
+	Iterator(Node* _ptr, const BinarySearchTree* _tree) : node_ptr{_ptr}, tree{_tree} {};
 };
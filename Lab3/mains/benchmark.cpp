@@ -0,0 +1,189 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <string>
+#include <cstdlib>    //std::atoi
+#include <cassert>    //assert
+
+#include "BinarySearchTree.h"
+#include "BTree.h"
+
+/* *************************************************************** *
+ * Benchmark of the BinarySearchTree operations                    *
+ *                                                                 *
+ * insert, contains, in-order iteration, clone (copy constructor), *
+ * remove and makeEmpty are timed for random and sorted insertion  *
+ * orders, with both balancing policies and both node allocation   *
+ * policies. Sorted input degrades the Unbalanced tree to a linked *
+ * list. frozen is contains on the snapshot made by freeze(), and *
+ * bulk is the bulk constructor from the values                    *
+ * The B-tree (BTree.h) is timed with the same operations, it has  *
+ * no snapshot and no bulk constructor, these columns are 0        *
+ *                                                                 *
+ * Usage: benchmark [size ...]                                     *
+ *   e.g. benchmark 1000 100000 1000000                            *
+ *   default sizes 1e3 .. 1e6                                      *
+ *   sorted input into an Unbalanced tree is limited to 2e4        *
+ *   values, since every operation is linear                       *
+ *                                                                 *
+ * Build from Lab3 with optimizations, e.g.                        *
+ *   g++ -std=c++17 -O2 -I. mains/benchmark.cpp -o benchmark       *
+ * *************************************************************** */
+
+namespace {
+    // Results of the queries are accumulated here, so that they are not optimized away
+    volatile size_t sink = 0;
+
+    const size_t max_degenerate = 20000;
+
+    using Clock = std::chrono::steady_clock;
+
+    // Nanoseconds per operation, for n operations since start
+    double ns_per_op(Clock::time_point start, size_t n) {
+        std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+        return elapsed.count() / static_cast<double>(n);
+    }
+
+    // Nanoseconds per contains on the snapshot of t
+    template <typename Balance, typename Alloc>
+    double frozen_contains(const BinarySearchTree<int, Balance, Alloc>& t, const std::vector<int>& queries) {
+        FrozenBST<int> snapshot = t.freeze();
+
+        auto start = Clock::now();
+        for (int x : queries) {
+            sink = sink + (snapshot.contains(x) != snapshot.end());
+        }
+        return ns_per_op(start, queries.size());
+    }
+
+    // Nanoseconds per value of the bulk constructor
+    template <typename Balance, typename Alloc>
+    double bulk_load(const BinarySearchTree<int, Balance, Alloc>&, const std::vector<int>& values) {
+        auto start = Clock::now();
+        BinarySearchTree<int, Balance, Alloc> t{values.begin(), values.end()};
+        double time = ns_per_op(start, values.size());
+
+        sink = sink + t.size();
+        return time;
+    }
+
+    // A BTree has no snapshot and no bulk constructor
+    template <std::size_t NodeBytes>
+    double frozen_contains(const BTree<int, NodeBytes>&, const std::vector<int>&) {
+        return 0.0;
+    }
+
+    template <std::size_t NodeBytes>
+    double bulk_load(const BTree<int, NodeBytes>&, const std::vector<int>&) {
+        return 0.0;
+    }
+}
+
+// Time the operations of a Tree, for the values in insertion order
+template <typename Tree>
+void run(const char* policy, const char* nodes, const char* order, const std::vector<int>& values) {
+    const size_t n = values.size();
+
+    std::vector<int> queries = values;
+    std::shuffle(queries.begin(), queries.end(), std::mt19937{7});
+
+    Tree* t = new Tree{};
+
+    auto start = Clock::now();
+    for (int x : values) {
+        t->insert(x);
+    }
+    double insert = ns_per_op(start, n);
+
+    double bulk = bulk_load(*t, values);
+
+    start = Clock::now();
+    for (int x : queries) {
+        sink = sink + (t->contains(x) != t->end());
+    }
+    double contains = ns_per_op(start, n);
+
+    double frozen = frozen_contains(*t, queries);
+
+    start = Clock::now();
+    for (int x : *t) {
+        sink = sink + x;
+    }
+    double iterate = ns_per_op(start, n);
+
+    start = Clock::now();
+    Tree* copy = new Tree{*t};
+    double clone = ns_per_op(start, n);
+
+    start = Clock::now();
+    for (int x : queries) {
+        t->remove(x);
+    }
+    double remove = ns_per_op(start, n);
+    assert(t->isEmpty());
+
+    start = Clock::now();
+    copy->makeEmpty();
+    double make_empty = ns_per_op(start, n);
+
+    delete t;
+    delete copy;
+    assert(Tree::get_count_nodes() == 0);
+
+    std::cout << std::setw(12) << policy << std::setw(6) << nodes << std::setw(8) << order << std::setw(10) << n
+              << std::fixed << std::setprecision(1)
+              << std::setw(10) << insert << std::setw(10) << bulk << std::setw(10) << contains << std::setw(10) << frozen
+              << std::setw(10) << iterate
+              << std::setw(10) << clone
+              << std::setw(10) << remove << std::setw(11) << make_empty << '\n';
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<size_t> sizes;
+
+    for (int i = 1; i < argc; ++i) {
+        sizes.push_back(static_cast<size_t>(std::atoi(argv[i])));
+    }
+    if (sizes.empty()) {
+        sizes = {1000, 10000, 100000, 1000000};
+    }
+
+    std::cout << "Nanoseconds per value\n\n";
+    std::cout << std::setw(12) << "policy" << std::setw(6) << "nodes" << std::setw(8) << "order" << std::setw(10) << "n"
+              << std::setw(10) << "insert" << std::setw(10) << "bulk" << std::setw(10) << "contains" << std::setw(10) << "frozen"
+              << std::setw(10) << "iterate"
+              << std::setw(10) << "clone"
+              << std::setw(10) << "remove" << std::setw(11) << "makeEmpty" << '\n';
+
+    for (size_t n : sizes) {
+        std::vector<int> sorted(n);
+        for (size_t i = 0; i < n; ++i) {
+            sorted[i] = static_cast<int>(i);
+        }
+
+        std::vector<int> random = sorted;
+        std::shuffle(random.begin(), random.end(), std::mt19937{42});
+
+        run<BinarySearchTree<int, Unbalanced, HeapNodes>>("Unbalanced", "heap", "random", random);
+        run<BinarySearchTree<int, Unbalanced, SlabNodes>>("Unbalanced", "slab", "random", random);
+        if (n <= max_degenerate) {
+            run<BinarySearchTree<int, Unbalanced, HeapNodes>>("Unbalanced", "heap", "sorted", sorted);
+            run<BinarySearchTree<int, Unbalanced, SlabNodes>>("Unbalanced", "slab", "sorted", sorted);
+        }
+
+        run<BinarySearchTree<int, AVLBalanced, HeapNodes>>("AVLBalanced", "heap", "random", random);
+        run<BinarySearchTree<int, AVLBalanced, SlabNodes>>("AVLBalanced", "slab", "random", random);
+        run<BinarySearchTree<int, AVLBalanced, HeapNodes>>("AVLBalanced", "heap", "sorted", sorted);
+        run<BinarySearchTree<int, AVLBalanced, SlabNodes>>("AVLBalanced", "slab", "sorted", sorted);
+
+        run<BTree<int>>("BTree", "heap", "random", random);
+        run<BTree<int>>("BTree", "heap", "sorted", sorted);
+    }
+
+    std::cout << "\n(sink " << sink << ")\n";
+
+    return 0;
+}
@@ -0,0 +1,676 @@
+#include <iostream>
+#include <vector>
+#include <iterator>
+#include <fstream>
+#include <sstream>
+#include <cassert>    //assert
+#include <algorithm>  //std::sort
+#include <cmath>      //std::log2
+#include <string>
+#include <stdexcept> //std::runtime_error
+#include <utility>    //std::pair
+#include <tuple>      //std::tie
+#include <type_traits>  //std::is_constructible
+
+#include "BinarySearchTree.h"
+
+// Test whether T has a member insert(A, B)
+template <typename T, typename A, typename B, typename = void>
+struct has_insert : std::false_type {};
+
+template <typename T, typename A, typename B>
+struct has_insert<T, A, B, std::void_t<decltype(std::declval<T &>().insert(std::declval<A>(), std::declval<B>()))>>
+    : std::true_type {};
+
+// Maximum height of an AVL tree with n nodes
+int max_avl_height(int n) {
+    return static_cast<int>(1.44 * std::log2(n + 2));
+}
+
+// Counted word, constructed from a word or a word and a count, comparable with words
+class Counted {
+public:
+    explicit Counted(const std::string& w, int n = 1) : word{w}, count{n} {
+        ++constructed;
+    }
+
+    Counted(const Counted& c) : word{c.word}, count{c.count} {
+        ++constructed;
+    }
+
+    bool operator<(const Counted& rhs) const { return word < rhs.word; }
+    friend bool operator<(const Counted& c, const std::string& w) { return c.word < w; }
+    friend bool operator<(const std::string& w, const Counted& c) { return w < c.word; }
+
+    std::string word;
+    int count;
+
+    static int constructed;  // number of constructed Counted
+};
+
+int Counted::constructed = 0;
+
+// Item whose copy throws once copies_left copies are made, copies are not counted while copies_left < 0
+class Fragile {
+public:
+    Fragile(int v) : value{v} {}
+
+    Fragile(const Fragile& f) : value{f.value} {
+        if (copies_left == 0) throw std::runtime_error{"copy failed"};
+        if (copies_left > 0) --copies_left;
+    }
+
+    Fragile(Fragile&&) = default;
+    Fragile& operator=(const Fragile&) = default;
+    Fragile& operator=(Fragile&&) = default;
+
+    bool operator<(const Fragile& rhs) const { return value < rhs.value; }
+
+    int value;
+
+    static int copies_left;
+};
+
+int Fragile::copies_left = -1;
+
+// Check that copying the items of V into a new tree of type Tree, or into a tree of 100 items, fails without a leak
+template <typename Tree>
+void check_bulk_failure(const std::vector<Fragile>& V) {
+    // V is copied into a vector, then the items are copied into the nodes
+    Fragile::copies_left = static_cast<int>(V.size()) + 40;
+    try {
+        Tree t{V.begin(), V.end()};
+        assert(false);
+    }
+    catch (const std::runtime_error&) {
+    }
+    Fragile::copies_left = -1;
+    assert(Tree::get_count_nodes() == 0);
+
+    std::vector<Fragile> odd;
+    for (int i = 1; i < 200; i += 2) {
+        odd.push_back(i);
+    }
+    Tree t{odd.begin(), odd.end()};
+
+    Fragile::copies_left = static_cast<int>(V.size()) + 40;
+    try {
+        t.insert(V.begin(), V.end());  // large batch, merged
+        assert(false);
+    }
+    catch (const std::runtime_error&) {
+    }
+    Fragile::copies_left = -1;
+    assert(Tree::get_count_nodes() == 100 && t.size() == 100);
+
+    int expected = 1;
+    for (const Fragile& f : t) {
+        assert(f.value == expected);
+        expected += 2;
+    }
+    assert(expected == 201);
+
+    // the tree and the pool still work
+    t.insert(V.begin(), V.end());
+    assert(t.size() == 100 + V.size() && Tree::get_count_nodes() == static_cast<int>(t.size()));
+}
+
+int main() {
+    using AVLTree = BinarySearchTree<int, AVLBalanced>;
+
+    /*************************************************/
+    std::cout << "PHASE 0: balanced insert, printTree\n\n";
+    /*************************************************/
+    {
+        AVLTree t;
+        assert(AVLTree::get_count_nodes() == 0);
+
+        std::vector<int> V = {20, 10, 30, 5, 15, 35, 25, 12, 14, 33};
+
+        for (auto j : V) {
+            t.insert(j);
+        }
+
+        assert(AVLTree::get_count_nodes() == 10);
+        assert(t.height() == 4);
+
+        // Display the tree
+        std::cout << "Tree: \n";
+        t.printTree();
+        std::cout << '\n';
+
+        // 14 was rotated above 12 and 15
+        std::ostringstream os;
+        t.printTree(os);
+        assert(os.str() == "20\n  10\n     5\n    14\n      12\n      15\n  30\n    25\n    35\n      33\n");
+
+        assert(t.findMin() == 5);
+        assert(t.findMax() == 35);
+        assert(t.get_parent(12) == 14 && t.get_parent(15) == 14 && t.get_parent(14) == 10);
+        assert(t.get_parent(20) == 0);
+    }
+
+    assert(AVLTree::get_count_nodes() == 0);
+
+    /*****************************************************/
+    std::cout << "\nPHASE 1: sorted input, contains, iterators\n";
+    /*****************************************************/
+    {
+        const int n = 100000;
+
+        AVLTree t;
+        BinarySearchTree<int> unbalanced;
+
+        for (int i = 0; i < n; ++i) {
+            t.insert(i);
+        }
+        for (int i = 0; i < 1000; ++i) {
+            unbalanced.insert(i);
+        }
+
+        assert(AVLTree::get_count_nodes() == n);
+        assert(t.height() <= max_avl_height(n));
+        assert(unbalanced.height() == 1000);  // a linked list
+
+        for (int i = 0; i < n; i += 7) {
+            assert(*t.contains(i) == i);
+        }
+        assert(t.contains(-1) == t.end() && t.contains(n) == t.end());
+
+        // The parent pointers are maintained by the rotations
+        int expected = 0;
+        for (int x : t) {
+            assert(x == expected++);
+        }
+        assert(expected == n);
+
+        for (auto it = t.contains(n - 1); it != t.end(); --it) {
+            assert(*it == --expected);
+        }
+        assert(expected == 0);
+    }
+
+    assert(AVLTree::get_count_nodes() == 0);
+
+    /*****************************************************/
+    std::cout << "\nPHASE 2: remove, find_pred_succ\n";
+    /*****************************************************/
+    {
+        const int n = 10000;
+
+        AVLTree t;
+        for (int i = n - 1; i >= 0; --i) {
+            t.insert(i);
+        }
+
+        // Remove the even values, from the smallest one, so that the tree leans to the right
+        for (int i = 0; i < n; i += 2) {
+            t.remove(i);
+        }
+
+        assert(AVLTree::get_count_nodes() == n / 2);
+        assert(t.height() <= max_avl_height(n / 2));
+
+        for (int i = 0; i < n; ++i) {
+            assert((t.contains(i) != t.end()) == (i % 2 == 1));
+        }
+
+        auto p = t.find_pred_succ(101);
+        assert(p.first == 99 && p.second == 103);
+
+        p = t.find_pred_succ(100);
+        assert(p.first == 99 && p.second == 101);
+
+        std::vector<int> V1;
+        for (auto it = t.begin(); it != t.end(); ++it) {
+            V1.push_back(*it);
+        }
+        assert(V1.size() == n / 2 && std::is_sorted(V1.begin(), V1.end()));
+
+        for (auto it = t.contains(n - 1); it != t.end(); --it) {
+            assert(*it == V1.back());
+            V1.pop_back();
+        }
+        assert(V1.empty());
+
+        // Copies keep the balanced shape
+        AVLTree t2{t};
+        std::ostringstream os1;
+        std::ostringstream os2;
+        t.printTree(os1);
+        t2.printTree(os2);
+        assert(os1.str() == os2.str() && t2.height() == t.height());
+
+        t.makeEmpty();
+        assert(t.isEmpty() && AVLTree::get_count_nodes() == n / 2);
+    }
+
+    assert(AVLTree::get_count_nodes() == 0);
+
+    /**************************************************/
+    std::cout << "\nPHASE 3: sorted words\n";
+    /**************************************************/
+    {
+        std::ifstream file{"./other files/words.txt"};
+
+        if (!file) {
+            std::cout << "Couldn't open file words.txt\n";
+            return 1;
+        }
+
+        std::vector<std::string> V{std::istream_iterator<std::string>{file},
+                                   std::istream_iterator<std::string>{}};
+        file.close();
+
+        std::sort(V.begin(), V.end());
+
+        BinarySearchTree<std::string, AVLBalanced> t;
+        for (const auto& w : V) {
+            t.insert(w);
+        }
+
+        assert((BinarySearchTree<std::string, AVLBalanced>::get_count_nodes() == 35));
+        assert(t.height() <= max_avl_height(35));
+
+        std::vector<std::string> V1;
+        for (const auto& w : t) {
+            V1.push_back(w);
+        }
+        V.erase(std::unique(V.begin(), V.end()), V.end());
+        assert(V1 == V);
+    }
+
+    assert((BinarySearchTree<std::string, AVLBalanced>::get_count_nodes() == 0));
+
+    /**************************************************/
+    std::cout << "\nPHASE 4: degenerate trees\n";
+    /**************************************************/
+    {
+        // Sorted input makes a linked list, which is cloned, searched and destroyed without recursion
+        const int n = 10000;
+
+        BinarySearchTree<int> t;
+        for (int i = 0; i < n; ++i) {
+            t.insert(i);
+        }
+        assert(t.height() == n);
+
+        BinarySearchTree<int> t2{t};
+        assert(BinarySearchTree<int>::get_count_nodes() == 2 * n && t2.height() == n);
+        assert(*t2.contains(n - 1) == n - 1 && t2.get_parent(n - 1) == n - 2);
+
+        t2.remove(0);
+        t2.remove(n / 2);
+        assert(t2.findMin() == 1 && t2.contains(n / 2) == t2.end() && t2.get_parent(n / 2 + 1) == n / 2 - 1);
+
+        int expected = 1;
+        for (int x : t2) {
+            if (expected == n / 2) ++expected;
+            assert(x == expected++);
+        }
+        assert(expected == n);
+
+        t.makeEmpty();
+        assert(BinarySearchTree<int>::get_count_nodes() == n - 2);
+    }
+
+    assert(BinarySearchTree<int>::get_count_nodes() == 0);
+
+    /**************************************************/
+    std::cout << "\nPHASE 5: slab allocated nodes\n";
+    /**************************************************/
+    {
+        using SlabTree = BinarySearchTree<int, AVLBalanced, SlabNodes>;
+        const int n = 10000;
+
+        SlabTree t;
+        for (int i = 0; i < n; ++i) {
+            t.insert(i);
+        }
+        assert(SlabTree::get_count_nodes() == n && t.height() <= max_avl_height(n));
+
+        // Freed slots are reused
+        for (int i = 0; i < n; i += 2) {
+            t.remove(i);
+        }
+        for (int i = n; i < 2 * n; i += 2) {
+            t.insert(i);
+        }
+        assert(SlabTree::get_count_nodes() == n);
+
+        // The odd values below n, then the even values from n
+        int expected = 1;
+        for (int x : t) {
+            assert(x == expected);
+            expected += (expected == n - 1) ? 1 : 2;
+        }
+        assert(expected == 2 * n);
+
+        // Copies have their own slabs
+        SlabTree t2{t};
+        SlabTree t3;
+        t3.insert(-1);
+        t3 = t;
+        assert(SlabTree::get_count_nodes() == 3 * n);
+
+        t.makeEmpty();
+        assert(t.isEmpty() && SlabTree::get_count_nodes() == 2 * n);
+        assert(*t2.contains(n + 2) == n + 2 && *t3.contains(n - 1) == n - 1 && t2.findMin() == 1);
+
+        // Slabs are reused after makeEmpty
+        for (int i = 0; i < 100; ++i) {
+            t.insert(i);
+        }
+        assert(t.findMax() == 99 && SlabTree::get_count_nodes() == 2 * n + 100);
+
+        // Elements with destructors
+        BinarySearchTree<std::string, Unbalanced, SlabNodes> words;
+        for (int i = 0; i < 1000; ++i) {
+            words.insert("word" + std::to_string(i));
+        }
+        words.remove("word500");
+        assert(words.contains("word500") == words.end() && *words.contains("word999") == "word999");
+        words.makeEmpty();
+        assert((BinarySearchTree<std::string, Unbalanced, SlabNodes>::get_count_nodes() == 0));
+    }
+
+    assert((BinarySearchTree<int, AVLBalanced, SlabNodes>::get_count_nodes() == 0));
+
+    /**************************************************/
+    std::cout << "\nPHASE 6: iterators along the in-order links\n";
+    /**************************************************/
+    {
+        std::vector<int> V = {20, 10, 30, 5, 15, 35, 25, 12, 14, 33};
+
+        AVLTree t;
+        for (auto j : V) {
+            t.insert(j);
+        }
+
+        // Post increment and decrement return the old position
+        auto it = t.begin();
+        assert(*it++ == 5 && *it == 10);
+        assert(*it-- == 10 && *it == 5);
+
+        // Decrementing end() gives the largest item
+        it = t.end();
+        assert(*--it == 35);
+        it = t.end();
+        it--;
+        assert(*it == 35);
+
+        // The links follow removals, with one and two children, and rotations
+        t.remove(10);
+        t.remove(30);
+        t.remove(5);
+        t.insert(31);
+        t.insert(4);
+
+        std::vector<int> expected = {4, 12, 14, 15, 20, 25, 31, 33, 35};
+        std::vector<int> V1;
+        for (it = t.begin(); it != t.end(); ++it) {
+            V1.push_back(*it);
+        }
+        assert(V1 == expected);
+
+        std::vector<int> V2;
+        for (it = t.end(); it != t.begin();) {
+            V2.push_back(*--it);
+        }
+        std::reverse(V2.begin(), V2.end());
+        assert(V2 == expected);
+
+        // A removed node with two children is replaced by its successor's node:
+        // iterators to the other items, the successor's included, stay valid
+        BinarySearchTree<int> u;
+        for (int x : {50, 30, 70, 60, 80, 65}) {
+            u.insert(x);
+        }
+        auto it60 = u.contains(60);
+        auto it65 = u.contains(65);
+        auto it70 = u.contains(70);
+
+        u.remove(50); // successor 60, a leftmost node with a right child
+        assert(*it60 == 60 && *it65 == 65 && u.get_parent(30) == 60 && u.get_parent(65) == 70);
+        u.remove(60); // successor 65, a leaf
+        auto before70 = it70;
+        assert(*it65 == 65 && *--before70 == 65 && u.get_parent(70) == 65 && u.get_parent(30) == 65);
+        u.remove(65); // successor 70, the right child
+        assert(*++it70 == 80 && *--it70 == 70 && u.get_parent(30) == 70 && u.get_parent(80) == 70);
+
+        AVLTree a;
+        std::vector<AVLTree::Iterator> items;
+        for (int i = 0; i < 500; ++i) {
+            items.push_back(a.insert(i).first);
+        }
+        for (int i = 0; i < 500; i += 2) {
+            a.remove((i * 7) % 500);
+            for (int j = 1; j < 500; j += 2) {
+                assert(*items[(j * 7) % 500] == (j * 7) % 500);
+            }
+        }
+        assert(a.size() == 250 && a.height() <= max_avl_height(250));
+
+        // Copies have their own links
+        AVLTree t2{t};
+        t.makeEmpty();
+
+        V1.clear();
+        for (int x : t2) {
+            V1.push_back(x);
+        }
+        assert(V1 == expected);
+        assert(*--t2.end() == 35 && *--t2.contains(20) == 15);
+    }
+
+    assert(AVLTree::get_count_nodes() == 0);
+
+    /**************************************************/
+    std::cout << "\nPHASE 7: bulk load and bulk insert\n";
+    /**************************************************/
+    {
+        // Unsorted, with duplicates, large enough to be sorted in parallel
+        const int n = 100000;
+        std::vector<int> V;
+        for (int i = 0; i < 2 * n; ++i) {
+            V.push_back((i * 7919) % n);
+        }
+
+        BinarySearchTree<int> t{V.begin(), V.end()};
+        assert(t.size() == n && BinarySearchTree<int>::get_count_nodes() == n);
+        assert(t.height() == 17);  // perfectly balanced, ceil(log2(n + 1))
+
+        int expected = 0;
+        for (int x : t) {
+            assert(x == expected++);
+        }
+        assert(expected == n);
+        assert(*--t.end() == n - 1);
+
+        // The middle item is the root, the middle of the smaller half its left child
+        assert(t.get_parent(n / 2) == 0 && t.get_parent(n / 4) == n / 2 && t.get_parent(n / 8) == n / 4);
+
+        // Small batch, inserted item by item
+        std::vector<int> small = {-5, -1, n + 3, 10};
+        t.insert(small.begin(), small.end());
+        assert(t.size() == n + 3 && t.findMin() == -5 && t.findMax() == n + 3);
+
+        // Large batch, merged and rebuilt, the old nodes are reused
+        std::vector<int> large;
+        for (int i = n + 10; i < 3 * n; i += 2) {
+            large.push_back(i);
+        }
+        t.insert(large.begin(), large.end());
+        assert(t.size() == n + 3 + large.size() && t.height() == 18);
+        assert(BinarySearchTree<int>::get_count_nodes() == static_cast<int>(t.size()));
+        assert(t.contains(n + 3) != t.end() && t.contains(n + 11) == t.end() && t.contains(3 * n - 2) != t.end());
+
+        std::vector<int> V1{-5, -1};
+        for (int i = 0; i < n; ++i) V1.push_back(i);
+        V1.push_back(n + 3);
+        V1.insert(V1.end(), large.begin(), large.end());
+
+        auto it = t.begin();
+        for (int x : V1) {
+            assert(*it++ == x);
+        }
+        assert(it == t.end());
+
+        // The AVL policy keeps working on a bulk loaded tree
+        AVLTree a{V.begin(), V.end()};
+        for (int i = 0; i < n; i += 3) {
+            a.remove(i);
+        }
+        for (int i = n; i < 2 * n; ++i) {
+            a.insert(i);
+        }
+        assert(a.height() <= max_avl_height(static_cast<int>(a.size())));
+
+        // Slab nodes and strings
+        std::vector<std::string> W = {"pear", "apple", "fig", "apple", "kiwi", "fig"};
+        BinarySearchTree<std::string, AVLBalanced, SlabNodes> w{W.begin(), W.end()};
+        assert(w.size() == 4 && w.findMin() == "apple" && w.findMax() == "pear");
+
+        std::vector<std::string> W2 = {"banana", "cherry", "date", "lime", "mango", "plum"};
+        w.insert(W2.begin(), W2.end());
+        assert(w.size() == 10 && w.height() == 4 && *--w.contains("date") == "cherry");
+
+        BinarySearchTree<int> empty{V.begin(), V.begin()};
+        assert(empty.isEmpty() && empty.size() == 0);
+
+        // Two items are not a range: BinarySearchTree<int> t(3, 4) and t.insert(5, 6) do not compile
+        static_assert(std::is_constructible<BinarySearchTree<int>, const int *, const int *>::value, "range");
+        static_assert(!std::is_constructible<BinarySearchTree<int>, int, int>::value, "two items");
+        static_assert(has_insert<BinarySearchTree<int>, const int *, const int *>::value, "range");
+        static_assert(!has_insert<BinarySearchTree<int>, int, int>::value, "two items");
+    }
+
+    assert(BinarySearchTree<int>::get_count_nodes() == 0 && AVLTree::get_count_nodes() == 0);
+
+    /**************************************************/
+    std::cout << "\nPHASE 8: insert results, emplace, try_emplace, hints\n";
+    /**************************************************/
+    {
+        AVLTree t;
+
+        auto [it, inserted] = t.insert(20);
+        assert(inserted && *it == 20);
+
+        std::tie(it, inserted) = t.insert(20);
+        assert(!inserted && *it == 20 && t.size() == 1);
+
+        int x = 10;
+        std::tie(it, inserted) = t.insert(std::move(x));
+        assert(inserted && *it == 10 && *++it == 20);
+
+        std::tie(it, inserted) = t.emplace(30);
+        assert(inserted && *it == 30 && t.size() == 3);
+
+        std::tie(it, inserted) = t.emplace(10);
+        assert(!inserted && *it == 10 && AVLTree::get_count_nodes() == 3);
+
+        // Counting: one construction per distinct word, none for the repeated words
+        std::vector<std::string> words = {"b", "a", "c", "a", "b", "a"};
+        BinarySearchTree<Counted> counts;
+
+        for (const auto& w : words) {
+            auto [pos, added] = counts.try_emplace(w);
+            if (!added) ++pos->count;
+        }
+        assert(Counted::constructed == 3 && counts.size() == 3);
+        assert(counts.findMin().word == "a" && counts.findMin().count == 3);
+        assert(counts.try_emplace(std::string{"d"}, 5).first->count == 5);
+
+        // Hinted inserts: sorted input with hint end(), then hints in the middle
+        AVLTree h;
+        for (int i = 0; i < 1000; i += 2) {
+            auto pos = h.insert(h.end(), i);
+            assert(*pos == i);
+        }
+        assert(h.size() == 500 && h.height() <= max_avl_height(500));
+
+        auto pos = h.insert(h.contains(102), 101);  // right hint
+        assert(*pos == 101 && *--pos == 100);
+        pos = h.insert(h.contains(500), 103);  // wrong hint, inserted from the root
+        assert(*pos == 103 && *++pos == 104);
+        pos = h.insert(h.begin(), 0);  // duplicate
+        assert(*pos == 0 && h.size() == 502);
+        pos = h.insert(h.begin(), -1);
+        assert(*pos == -1 && h.findMin() == -1);
+
+        int expected = -1;
+        for (int v : h) {
+            assert(v == expected);
+            expected = (v == -1) ? 0 : (v == 100) ? 101 : (v == 101) ? 102 : (v == 102) ? 103 : (v == 103) ? 104 : v + 2;
+        }
+        assert(expected == 1000);
+
+        BinarySearchTree<int> e;
+        assert(*e.insert(e.end(), 7) == 7 && e.size() == 1);
+
+        // Sorted input with hint end() on an Unbalanced tree, a list: every item is linked after the largest one,
+        // without walking the right spine, so this takes milliseconds instead of minutes
+        const int m = 100000;
+        BinarySearchTree<int> u;
+        for (int i = 0; i < m; ++i) {
+            u.insert(u.end(), i);
+        }
+        assert(u.size() == m && u.height() == m && *--u.end() == m - 1 && u.findMax() == m - 1);
+
+        // The largest node is kept by every operation
+        u.remove(m - 1);
+        assert(*--u.end() == m - 2 && u.findMax() == m - 2);
+
+        BinarySearchTree<int> c{u};
+        c.insert(c.end(), m + 5);
+        assert(*--c.end() == m + 5 && *--u.end() == m - 2);
+
+        c = e;
+        assert(*--c.end() == 7 && c.findMax() == 7);
+
+        u.makeEmpty();
+        assert(u.begin() == u.end() && --u.end() == u.end());
+        u.insert(u.end(), 3);
+        assert(*--u.end() == 3 && u.size() == 1);
+
+        std::vector<int> batch = {9, 1, 5, 7};
+        u.insert(batch.begin(), batch.end());  // merged and rebuilt
+        assert(*--u.end() == 9 && u.findMax() == 9);
+
+        // Removing a node with two children moves the item of its successor, the largest one, into it
+        AVLTree r;
+        for (int v : {20, 10, 30}) {
+            r.insert(v);
+        }
+        r.remove(20);
+        assert(*--r.end() == 30 && r.get_parent(10) == 30);
+        r.remove(30);
+        assert(*--r.end() == 10 && r.findMax() == 10);
+        r.remove(10);
+        assert(r.isEmpty() && --r.end() == r.end());
+        assert(*r.insert(r.end(), 4) == 4 && *--r.end() == 4);
+    }
+
+    assert(AVLTree::get_count_nodes() == 0);
+
+    /**************************************************/
+    std::cout << "\nPHASE 9: exceptions in bulk load and bulk insert\n";
+    /**************************************************/
+    {
+        // even items, in reverse order
+        std::vector<Fragile> V;
+        for (int i = 398; i >= 0; i -= 2) {
+            V.push_back(i);
+        }
+
+        check_bulk_failure<BinarySearchTree<Fragile>>(V);
+        check_bulk_failure<BinarySearchTree<Fragile, AVLBalanced, SlabNodes>>(V);
+    }
+
+    assert(BinarySearchTree<Fragile>::get_count_nodes() == 0);
+    assert((BinarySearchTree<Fragile, AVLBalanced, SlabNodes>::get_count_nodes() == 0));
+
+    std::cout << "\nSuccess!!\n";
+
+    return 0;
+}
@@ -0,0 +1,158 @@
+#include <iostream>
+#include <vector>
+#include <iterator>
+#include <fstream>
+#include <cassert>    //assert
+#include <algorithm>  //std::sort, std::lower_bound
+#include <string>
+#include <random>     //std::mt19937
+
+#include "BinarySearchTree.h"
+
+// Item without a default constructor
+class Word {
+public:
+    explicit Word(const std::string& w) : word{w} {}
+
+    bool operator<(const Word& rhs) const {
+        return word < rhs.word;
+    }
+
+    const std::string& get() const {
+        return word;
+    }
+
+private:
+    std::string word;
+};
+
+int main() {
+    /*************************************************/
+    std::cout << "PHASE 0: freeze, contains, findMin, findMax\n";
+    /*************************************************/
+    {
+        BinarySearchTree<int> t;
+        std::vector<int> V = {20, 10, 30, 5, 15, 35, 25, 12, 14, 33};
+
+        for (auto j : V) {
+            t.insert(j);
+        }
+
+        FrozenBST<int> f = t.freeze();
+        assert(f.size() == V.size() && !f.isEmpty());
+        assert(f.findMin() == 5 && f.findMax() == 35);
+
+        for (auto j : V) {
+            assert(*f.contains(j) == j);
+        }
+        assert(f.contains(0) == f.end() && f.contains(13) == f.end() && f.contains(40) == f.end());
+
+        // The snapshot does not change with the tree
+        t.remove(20);
+        t.insert(21);
+        assert(*f.contains(20) == 20 && f.contains(21) == f.end());
+
+        FrozenBST<int> empty = BinarySearchTree<int>{}.freeze();
+        assert(empty.isEmpty() && empty.begin() == empty.end());
+        assert(empty.contains(1) == empty.end() && empty.lower_bound(1) == empty.end());
+
+        try {
+            empty.findMin();
+            assert(false);
+        }
+        catch (const UnderflowException&) {
+        }
+    }
+
+    /*****************************************************/
+    std::cout << "\nPHASE 1: lower_bound and iterators, all sizes up to 100\n";
+    /*****************************************************/
+    {
+        for (int n = 0; n <= 100; ++n) {
+            // Even values 0, 2, ..., 2(n - 1), inserted in random order
+            std::vector<int> V;
+            for (int i = 0; i < n; ++i) {
+                V.push_back(2 * i);
+            }
+
+            std::vector<int> shuffled = V;
+            std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937{static_cast<unsigned>(n)});
+
+            BinarySearchTree<int, AVLBalanced> t;
+            for (int x : shuffled) {
+                t.insert(x);
+            }
+
+            FrozenBST<int> f = t.freeze();
+            assert(static_cast<int>(f.size()) == n);
+
+            for (int x = -1; x <= 2 * n; ++x) {
+                auto it = f.lower_bound(x);
+                auto expected = std::lower_bound(V.begin(), V.end(), x);
+
+                if (expected == V.end()) {
+                    assert(it == f.end());
+                }
+                else {
+                    assert(*it == *expected);
+                }
+                assert((f.contains(x) != f.end()) == (x >= 0 && x % 2 == 0 && x < 2 * n));
+            }
+
+            // In order, forwards and backwards
+            std::vector<int> V1{f.begin(), f.end()};
+            assert(V1 == V);
+
+            std::vector<int> V2;
+            for (auto it = f.end(); it != f.begin();) {
+                V2.push_back(*--it);
+            }
+            std::reverse(V2.begin(), V2.end());
+            assert(V2 == V);
+        }
+    }
+
+    /**************************************************/
+    std::cout << "\nPHASE 2: words\n";
+    /**************************************************/
+    {
+        std::ifstream file{"./other files/words.txt"};
+
+        if (!file) {
+            std::cout << "Couldn't open file words.txt\n";
+            return 1;
+        }
+
+        std::vector<std::string> V{std::istream_iterator<std::string>{file},
+                                   std::istream_iterator<std::string>{}};
+        file.close();
+
+        BinarySearchTree<Word> t;
+        for (const auto& w : V) {
+            t.insert(Word{w});
+        }
+
+        FrozenBST<Word> f = t.freeze();
+        assert(f.size() == 35);
+
+        for (const auto& w : V) {
+            assert(f.contains(Word{w})->get() == w);
+        }
+        assert(f.contains(Word{"zzz"}) == f.end());
+
+        std::sort(V.begin(), V.end());
+        V.erase(std::unique(V.begin(), V.end()), V.end());
+
+        auto it = f.begin();
+        for (const auto& w : V) {
+            assert((it++)->get() == w);
+        }
+        assert(it == f.end());
+    }
+
+    assert(BinarySearchTree<Word>::get_count_nodes() == 0);
+
+    std::cout << "\nSuccess!!\n";
+
+    return 0;
+}
@@ -0,0 +1,222 @@
+#include <iostream>
+#include <vector>
+#include <iterator>
+#include <fstream>
+#include <sstream>
+#include <cassert>    //assert
+#include <algorithm>  //std::sort
+#include <string>
+#include <set>
+#include <random>     //std::mt19937
+
+#include "BTree.h"
+
+// B-tree of at most 4 items per node, to have many levels with few items
+using SmallTree = BTree<int, 4 * sizeof(int)>;
+
+// Compare the items of t with the items of S, forwards and backwards
+template <typename Tree>
+void check(const Tree& t, const std::set<int>& S) {
+    assert(t.size() == S.size() && t.isEmpty() == S.empty());
+
+    auto it = t.begin();
+    for (int x : S) {
+        assert(it != t.end() && *it == x);
+        ++it;
+    }
+    assert(it == t.end());
+
+    for (auto rit = S.rbegin(); rit != S.rend(); ++rit) {
+        assert(*--it == *rit);
+    }
+    assert(it == t.begin());
+}
+
+int main() {
+    static_assert(SmallTree::Capacity == 4, "4 items per node");
+
+    /*************************************************/
+    std::cout << "PHASE 0: insert, printTree, find_pred_succ\n";
+    /*************************************************/
+    {
+        SmallTree t;
+        assert(SmallTree::get_count_nodes() == 0);
+
+        std::vector<int> V = {20, 10, 30, 5, 15, 35, 25, 12, 14, 33};
+
+        for (auto j : V) {
+            t.insert(j);
+        }
+        t.insert(14);  // duplicate
+
+        assert(t.size() == 10 && t.height() == 2);
+
+        // Display the tree
+        std::cout << "Tree: \n";
+        t.printTree();
+        std::cout << '\n';
+
+        // Full leaves were split at 15 and 25
+        std::ostringstream os;
+        t.printTree(os);
+        assert(os.str() == "[15 25]\n  [5 10 12 14]\n  [15 20]\n  [25 30 33 35]\n");
+
+        assert(t.findMin() == 5 && t.findMax() == 35);
+        assert(*t.contains(25) == 25 && t.contains(26) == t.end());
+        assert(t.get_parent(5) == 15 && t.get_parent(33) == 15 && t.get_parent(26) == 0);
+
+        // Same results as for BinarySearchTree, see test2.cpp
+        auto p = t.find_pred_succ(12);
+        assert(p.first == 10 && p.second == 14);
+
+        p = t.find_pred_succ(13);
+        assert(p.first == 12 && p.second == 14);
+
+        p = t.find_pred_succ(15);
+        assert(p.first == 14 && p.second == 20);
+
+        p = t.find_pred_succ(28);
+        assert(p.first == 25 && p.second == 30);
+
+        p = t.find_pred_succ(35);
+        assert(p.first == 33 && p.second == 35);
+
+        p = t.find_pred_succ(5);
+        assert(p.first == 5 && p.second == 10);
+    }
+
+    assert(SmallTree::get_count_nodes() == 0);
+
+    /*****************************************************/
+    std::cout << "\nPHASE 1: random insert and remove\n";
+    /*****************************************************/
+    {
+        std::mt19937 gen{42};
+        std::uniform_int_distribution<int> value{0, 2000};
+
+        SmallTree t;
+        std::set<int> S;
+
+        for (int round = 0; round < 20000; ++round) {
+            int x = value(gen);
+
+            if (gen() % 3 == 0) {
+                t.remove(x);
+                S.erase(x);
+            }
+            else {
+                t.insert(x);
+                S.insert(x);
+            }
+
+            assert(t.size() == S.size());
+            assert((t.contains(x) != t.end()) == (S.count(x) == 1));
+
+            if (round % 1000 == 0) {
+                check(t, S);
+            }
+        }
+        check(t, S);
+
+        // Remove everything, in random order
+        std::vector<int> V{S.begin(), S.end()};
+        std::shuffle(V.begin(), V.end(), gen);
+
+        for (int x : V) {
+            t.remove(x);
+            S.erase(x);
+        }
+        check(t, S);
+        assert(t.isEmpty() && t.height() == 0 && SmallTree::get_count_nodes() == 0);
+    }
+
+    /*****************************************************/
+    std::cout << "\nPHASE 2: sorted input, height, copies\n";
+    /*****************************************************/
+    {
+        const int n = 100000;
+
+        BTree<int> t;
+        for (int i = 0; i < n; ++i) {
+            t.insert(i);
+        }
+
+        // 64 items per node, nodes at least half full
+        assert(BTree<int>::Capacity == 64);
+        assert(t.height() <= 4);
+
+        for (int i = 0; i < n; i += 7) {
+            assert(*t.contains(i) == i);
+        }
+        assert(t.contains(-1) == t.end() && t.contains(n) == t.end());
+
+        BTree<int> t2{t};
+        BTree<int> t3;
+        t3.insert(-1);
+        t3 = t2;
+
+        for (int i = 0; i < n; i += 2) {
+            t.remove(i);
+        }
+
+        assert(t.size() == n / 2 && t2.size() == n && t3.size() == n);
+        assert(t.findMin() == 1 && t2.findMin() == 0 && t3.findMax() == n - 1);
+
+        int expected = 0;
+        for (int x : t3) {
+            assert(x == expected++);
+        }
+        assert(expected == n);
+
+        auto it = t.end();
+        for (int i = n - 1; i > 0; i -= 2) {
+            assert(*--it == i);
+        }
+        assert(it == t.begin());
+
+        t.makeEmpty();
+        t2.makeEmpty();
+        assert(t.isEmpty() && BTree<int>::get_count_nodes() > 0);
+    }
+
+    assert(BTree<int>::get_count_nodes() == 0);
+
+    /**************************************************/
+    std::cout << "\nPHASE 3: words\n";
+    /**************************************************/
+    {
+        std::ifstream file{"./other files/words.txt"};
+
+        if (!file) {
+            std::cout << "Couldn't open file words.txt\n";
+            return 1;
+        }
+
+        std::vector<std::string> V{std::istream_iterator<std::string>{file},
+                                   std::istream_iterator<std::string>{}};
+        file.close();
+
+        BTree<std::string, 4 * sizeof(std::string)> t;
+        for (const auto& w : V) {
+            t.insert(w);
+        }
+        assert(t.size() == 35 && t.height() > 1);
+
+        std::sort(V.begin(), V.end());
+        V.erase(std::unique(V.begin(), V.end()), V.end());
+
+        std::vector<std::string> V1{t.begin(), t.end()};
+        assert(V1 == V);
+
+        for (const auto& w : V) {
+            t.remove(w);
+        }
+        assert(t.isEmpty());
+    }
+
+    assert((BTree<std::string, 4 * sizeof(std::string)>::get_count_nodes() == 0));
+
+    std::cout << "\nSuccess!!\n";
+
+    return 0;
+}
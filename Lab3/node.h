@@ -1,19 +1,32 @@
+#include <cassert>
+#include <utility> //std::in_place and std::forward
+
 #include "BinarySearchTree.h"
 
 #pragma once
 
 // Define a node of the tree
-template <typename Comparable>
-struct BinarySearchTree<Comparable>::Node {
+template <typename Comparable, typename Balance, typename Alloc>
+struct BinarySearchTree<Comparable, Balance, Alloc>::Node {
     Comparable element;
 
     Node* left;   // pointer to left sub-tree
     Node* right;  // pointer to right sub-tree
     Node* parent; // pointer to the parent node, root.parent=nullptr
+    int height;   // number of levels of the sub-tree, maintained by the AVLBalanced policy only
+    Node* next;   // node of the next item in sorted order, nullptr for the largest item
+    Node* prev;   // node of the previous item in sorted order, nullptr for the smallest item
 
     // Constructors
     Node(const Comparable& theElement, Node* lt = nullptr, Node* rt = nullptr, Node* prnt = nullptr)
-        : element{theElement}, left{lt}, right{rt}, parent{prnt} {
+        : element{theElement}, left{lt}, right{rt}, parent{prnt}, height{1}, next{nullptr}, prev{nullptr} {
+        ++count_nodes;
+    }
+
+    // Construct the element in place from args, for a new leaf
+    template <typename... Args>
+    explicit Node(std::in_place_t, Args&&... args)
+        : element(std::forward<Args>(args)...), left{nullptr}, right{nullptr}, parent{nullptr}, height{1}, next{nullptr}, prev{nullptr} {
         ++count_nodes;
     }
 
@@ -33,5 +46,5 @@ struct BinarySearchTree<Comparable>::Node {
 };
 
 // Initialize static data member -- counter of nodes
-template <typename Comparable>
-int BinarySearchTree<Comparable>::Node::count_nodes = 0;
\ No newline at end of file
+template <typename Comparable, typename Balance, typename Alloc>
+int BinarySearchTree<Comparable, Balance, Alloc>::Node::count_nodes = 0;
\ No newline at end of file